@@ -0,0 +1,50 @@
+#include "util/cache_type.hpp"
+#include "cache/memory.hpp"
+#include <chrono>
+#include <cstdio>
+
+// TLB-heavy benchmark: random accesses to a large cache (64K sets x 16 ways) whose arrays span tens of MB,
+// the same cache is simulated with normal pages, transparent huge pages and reserved huge pages
+
+#define AddrN 4000000
+#define TestN 8000000
+
+typedef void data_type;
+typedef MetadataBroadcastBase meta_type;
+typedef MSIPolicy<true, true, policy_memory> policy_l1;
+
+static double run(CMHugePage policy) {
+  CMHugePageScope hp(policy);
+  auto l1 = cache_gen_l1<16, 16, data_type, meta_type, ReplaceLRU, MSIPolicy, policy_l1, true, void, false>(1, "l1");
+  auto mem = new SimpleMemoryModel<data_type, void, false>("mem");
+  l1[0]->outer->connect(mem);
+  auto core = get_l1_core_interface(l1)[0];
+
+  CMRandom rng(2024);
+  auto addr = std::vector<uint64_t>(AddrN);
+  for(auto &a : addr) a = (rng() & ((1ull << 36) - 1)) & ~0x3full; // a footprint larger than the cache
+
+  for(int i=0; i<AddrN; i++) core->read(addr[i], nullptr); // warm up
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i=0; i<TestN; i++) {
+    uint64_t a = addr[rng(AddrN)];
+    if(rng(4) == 0) core->write(a, nullptr, nullptr);
+    else            core->read(a, nullptr);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  delete l1[0];
+  delete mem;
+  return std::chrono::duration<double, std::nano>(end - start).count() / TestN;
+}
+
+int main() {
+  double none = run(CMHugePage::none);
+  double advise = run(CMHugePage::advise);
+  double hugetlb = run(CMHugePage::hugetlb); // falls back to advise when no huge page is reserved
+  printf("normal pages:      %6.1f ns/access\n", none);
+  printf("transparent huge:  %6.1f ns/access (%.2fx)\n", advise, none / advise);
+  printf("reserved huge:     %6.1f ns/access (%.2fx)\n", hugetlb, none / hugetlb);
+  return 0;
+}
@@ -1,8 +1,10 @@
 #ifndef CM_CACHE_CACHE_HPP
 #define CM_CACHE_CACHE_HPP
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -12,8 +14,12 @@
 #include "util/concept_macro.hpp"
 #include "util/query.hpp"
 #include "util/multithread.hpp"
+#include "util/simd.hpp"
+#include "util/alloc.hpp"
+#include "util/bloom.hpp"
 #include "cache/index.hpp"
 #include "cache/replace.hpp"
+#include "cache/deadblock.hpp"
 #include "cache/metadata.hpp"
 
 //#include <iostream>
@@ -27,6 +33,7 @@ public:
   virtual bool hit(uint64_t addr, uint32_t s, uint32_t *w) const = 0;
   virtual CMMetadataCommon * get_meta(uint32_t s, uint32_t w) = 0;
   virtual CMDataBase * get_data(uint32_t s, uint32_t w) = 0;
+  virtual bool set_allocated(uint32_t s) const { return true; } // false if set s is never allocated (all its lines are invalid)
 
   // support multithread
   virtual void set_mt_state(uint32_t s, uint16_t prio) = 0;   // preserve a cache set according to transaction priority
@@ -35,62 +42,19 @@ public:
   virtual void reset_mt_state(uint32_t s, uint16_t prio) = 0; // reset the state of a cache set after processing a transaction
 };
 
-// normal set associative cache array
-// IW: index width, NW: number of ways, MT: metadata type, DT: data type (void if not in use)
+// common multithread support for cache arrays
 // EnMT: enable multithread support
-template<int IW, int NW, typename MT, typename DT, bool EnMT>
-  requires C_DERIVE<MT, CMMetadataCommon> && C_DERIVE_OR_VOID<DT, CMDataBase>
-class CacheArrayNorm : public CacheArrayBase
+template<bool EnMT>
+class CacheArrayMTBase : public CacheArrayBase
 {
-  typedef typename std::conditional<EnMT, MetaLock<MT>, MT>::type C_MT;
 protected:
-  std::vector<C_MT *> meta;   // meta array
-  std::vector<DT *> data;     // data array, could be null
-  const unsigned int way_num;
   std::vector<AtomicVar<uint16_t> > cache_set_state;  // record current transactions for multithread support
 
 public:
-  static constexpr uint32_t nset = 1ul<<IW;  // number of sets
-
-  CacheArrayNorm(unsigned int extra_way = 0) : way_num(NW+extra_way){
-    size_t meta_num = nset * way_num;
-    constexpr size_t data_num = nset * NW;
-
-    meta.resize(meta_num);
-    for(auto &m:meta) m = new C_MT();
-    if(extra_way)
-      for(unsigned int s=0; s<nset; s++)
-        for(unsigned int w=NW; w<way_num; w++)
-          meta[s*way_num+w]->to_extend();
-
-    if constexpr (!C_VOID<DT>) {
-      data.resize(data_num);
-      for(auto &d:data) d = new DT();
-    }
-
+  CacheArrayMTBase(uint32_t nset) {
     if constexpr (EnMT) cache_set_state.resize(nset);
   }
 
-  virtual ~CacheArrayNorm() override {
-    for(auto m:meta) delete m;
-    if constexpr (!C_VOID<DT>) for(auto d:data) delete d;
-  }
-
-  virtual bool hit(uint64_t addr, uint32_t s, uint32_t *w) const override {
-    for(unsigned int i=0; i<way_num; i++)
-      if(meta[s*way_num + i]->match(addr)) {
-        *w = i;
-        return true;
-      }
-    return false;
-  }
-
-  virtual CMMetadataCommon * get_meta(uint32_t s, uint32_t w) override { return meta[s*way_num + w]; }
-  virtual CMDataBase * get_data(uint32_t s, uint32_t w) {
-    if constexpr (C_VOID<DT>) return nullptr;
-    else                      return data[s*NW + w];
-  }
-
   virtual __always_inline void set_mt_state(uint32_t s, uint16_t prio) override {
     if constexpr (EnMT) {
       while(true) {
@@ -134,6 +98,256 @@ public:
   }
 };
 
+// normal set associative cache array
+// IW: index width, NW: number of ways, MT: metadata type, DT: data type (void if not in use)
+// EnMT: enable multithread support
+// EnWP: enable way prediction, the most recently hit way of a set is checked before scanning the whole set (NW <= 256)
+template<int IW, int NW, typename MT, typename DT, bool EnMT, bool EnWP = false>
+  requires C_DERIVE<MT, CMMetadataCommon> && C_DERIVE_OR_VOID<DT, CMDataBase> && (!EnWP || NW <= 256)
+class CacheArrayNorm : public CacheArrayMTBase<EnMT>
+{
+  typedef typename std::conditional<EnMT, MetaLock<MT>, MT>::type C_MT;
+  template<typename T> using C_CNT = std::conditional_t<EnMT, std::atomic<T>, T>; // the hint is racy when EnMT
+
+  // EnMT: the counters are striped over slots of their own cache line, a thread counts in its own slot
+  //       (shared only beyond wp_slots threads) and the slots are summed on read
+  static constexpr unsigned int wp_slots = EnMT ? 16 : 1;
+  struct alignas(64) wp_cnt_t { C_CNT<uint64_t> hit = 0, pred = 0; }; // number of hits and correctly predicted hits
+
+protected:
+  const unsigned int way_num;
+  CMArena<C_MT> meta;         // meta array
+  CMArena<DT> data;           // data array, could be empty
+  mutable std::vector<C_CNT<uint8_t> > way_pred; // predicted way of each set
+  mutable wp_cnt_t wp_cnt[wp_slots];
+
+  __always_inline void way_pred_record(uint32_t s, uint32_t w, bool predicted) const {
+    if constexpr (EnMT) {
+      auto &cnt = wp_cnt[cm_thread_slot() % wp_slots];
+      if(!predicted) way_pred[s].store(w, std::memory_order_relaxed);
+      else           cnt.pred.fetch_add(1, std::memory_order_relaxed);
+      cnt.hit.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      if(!predicted) way_pred[s] = w;
+      else           wp_cnt[0].pred++;
+      wp_cnt[0].hit++;
+    }
+  }
+
+public:
+  static constexpr uint32_t nset = 1ul<<IW;  // number of sets
+  static constexpr size_t data_num = C_VOID<DT> ? 0 : nset * NW;  // number of data blocks
+
+  CacheArrayNorm(unsigned int extra_way = 0)
+    : CacheArrayMTBase<EnMT>(nset), way_num(NW+extra_way),
+      meta(nset * way_num), data(data_num), way_pred(EnWP ? nset : 0)
+  {
+    if(extra_way)
+      for(unsigned int s=0; s<nset; s++)
+        for(unsigned int w=NW; w<way_num; w++)
+          meta[s*way_num+w]->to_extend();
+  }
+
+  virtual bool hit(uint64_t addr, uint32_t s, uint32_t *w) const override {
+    if constexpr (EnWP) {
+      uint32_t p;
+      if constexpr (EnMT) p = way_pred[s].load(std::memory_order_relaxed);
+      else                p = way_pred[s];
+      if(meta[s*way_num + p]->match(addr)) {
+        way_pred_record(s, p, true);
+        *w = p;
+        return true;
+      }
+    }
+    for(unsigned int i=0; i<way_num; i++)
+      if(meta[s*way_num + i]->match(addr)) {
+        if constexpr (EnWP) way_pred_record(s, i, false);
+        *w = i;
+        return true;
+      }
+    return false;
+  }
+
+  virtual CMMetadataCommon * get_meta(uint32_t s, uint32_t w) override { return meta[s*way_num + w]; }
+  virtual CMDataBase * get_data(uint32_t s, uint32_t w) override {
+    if constexpr (C_VOID<DT>) return nullptr;
+    else                      return data[s*NW + w];
+  }
+
+  // accuracy of the way prediction: <number of hits, number of correctly predicted hits>
+  std::pair<uint64_t, uint64_t> way_pred_stat() const requires EnWP {
+    std::pair<uint64_t, uint64_t> rv(0, 0);
+    for(auto &cnt : wp_cnt) { rv.first += cnt.hit; rv.second += cnt.pred; }
+    return rv;
+  }
+  void way_pred_reset() requires EnWP { for(auto &cnt : wp_cnt) { cnt.hit = 0; cnt.pred = 0; } }
+};
+
+// normal set associative cache array with way prediction
+template<int IW, int NW, typename MT, typename DT, bool EnMT>
+using CacheArrayNormWP = CacheArrayNorm<IW, NW, MT, DT, EnMT, true>;
+
+// set associative cache array with a contiguous tag store (structure of arrays)
+// IW: index width, NW: number of ways, MT: metadata type, DT: data type (void if not in use)
+// EnMT: enable multithread support
+// The metadata of all lines are allocated in one arena (ways of a set are adjacent) and
+// each of them mirrors its tag into a per-set tag array aligned to cache lines.
+// hit() compares the tags of a set in parallel (SIMD when available) and only touches the metadata of a way with a matching tag.
+template<int IW, int NW, typename MT, typename DT, bool EnMT>
+  requires C_DERIVE<MT, CMMetadataBase> && C_DERIVE_OR_VOID<DT, CMDataBase>
+class CacheArraySoA : public CacheArrayMTBase<EnMT>
+{
+  typedef MetaTagMirror<typename std::conditional<EnMT, MetaLock<MT>, MT>::type> C_MT;
+protected:
+  const unsigned int way_num;
+  const unsigned int tag_stride;  // number of tags reserved for a set, padded to 64B
+  CMArena<C_MT> meta;             // meta array
+  uint64_t *tags;                 // tag array
+  CMArena<DT> data;               // data array, could be empty
+
+public:
+  static constexpr uint32_t nset = 1ul<<IW;  // number of sets
+  static constexpr size_t data_num = C_VOID<DT> ? 0 : nset * NW;  // number of data blocks
+
+  CacheArraySoA(unsigned int extra_way = 0)
+    : CacheArrayMTBase<EnMT>(nset), way_num(NW+extra_way), tag_stride((NW+extra_way+7) & ~7u),
+      meta(nset * way_num), data(data_num)
+  {
+    assert(tag_stride <= 64 || 0 == "the tag match mask of CacheArraySoA supports no more than 64 ways!");
+    tags = static_cast<uint64_t *>(cm_alloc_block(nset * tag_stride * sizeof(uint64_t)));
+    std::fill(tags, tags + nset * tag_stride, MetaTagMirror<MT>::no_tag);
+
+    for(unsigned int s=0; s<nset; s++)
+      for(unsigned int w=0; w<way_num; w++) {
+        meta[s*way_num+w]->bind_tag(tags + s*tag_stride + w);
+        if(w >= NW) meta[s*way_num+w]->to_extend();
+      }
+  }
+
+  virtual ~CacheArraySoA() override {
+    cm_free_block(tags, nset * tag_stride * sizeof(uint64_t));
+  }
+
+  virtual bool hit(uint64_t addr, uint32_t s, uint32_t *w) const override {
+    const uint64_t tag = MT::tag_of(addr);
+    for(uint64_t mask = match_mask(tags + s*tag_stride, tag); mask; mask &= mask - 1) {
+      uint32_t i = cm_ctz(mask);
+      if(meta[s*way_num + i]->match(addr)) { // the mirrored tag is only a hint
+        *w = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  virtual CMMetadataCommon * get_meta(uint32_t s, uint32_t w) override { return meta[s*way_num + w]; }
+  virtual CMDataBase * get_data(uint32_t s, uint32_t w) override {
+    if constexpr (C_VOID<DT>) return nullptr;
+    else                      return data[s*NW + w];
+  }
+
+protected:
+  // bitmask of the ways whose mirrored tag equals to tag (padding tags are no_tag and never match)
+  __always_inline uint64_t match_mask(const uint64_t *set_tags, uint64_t tag) const {
+    if constexpr (NW == 4 || NW == 8 || NW == 16 || NW == 32 || NW == 64) {
+      if(way_num == NW) return cm_match_mask<NW>(set_tags, tag);
+    }
+    uint64_t mask = 0; // other way numbers or with extra ways
+    for(unsigned int i=0; i<tag_stride; i+=8) mask |= cm_match_mask<8>(set_tags + i, tag) << i;
+    return mask;
+  }
+};
+
+// set associative cache array with sets allocated on demand (sparse)
+// IW: index width, NW: number of ways, MT: metadata type, DT: data type (void if not in use)
+// EnMT: enable multithread support
+// Sets are grouped into pages of 2^PW sets and a page is allocated when one of its sets is first accessed by get_meta().
+// hit() never allocates as all lines of an untouched set are invalid, and whole-cache scans (e.g. flush_cache())
+// skip the sets not set_allocated().
+template<int IW, int NW, typename MT, typename DT, bool EnMT>
+  requires C_DERIVE<MT, CMMetadataCommon> && C_DERIVE_OR_VOID<DT, CMDataBase>
+class CacheArraySparse : public CacheArrayMTBase<EnMT>
+{
+  typedef typename std::conditional<EnMT, MetaLock<MT>, MT>::type C_MT;
+  static constexpr uint32_t PW = IW < 6 ? IW : 6;
+  static constexpr uint32_t page_sets = 1ul << PW;
+  static constexpr uint32_t page_mask = page_sets - 1;
+
+  struct Page {
+    CMArena<C_MT> meta;
+    CMArena<DT> data;
+    Page(unsigned int way_num) : meta(page_sets * way_num), data(C_VOID<DT> ? 0 : page_sets * NW) {}
+  };
+
+protected:
+  const unsigned int way_num;
+  mutable std::vector<std::conditional_t<EnMT, std::atomic<Page *>, Page *> > pages;
+
+  __always_inline Page *read_page(uint32_t s) const {
+    if constexpr (EnMT) return pages[s >> PW].load(std::memory_order_acquire);
+    else                return pages[s >> PW];
+  }
+
+  Page *alloc_page(uint32_t s) {
+    auto page = new Page(way_num);
+    if(way_num > NW)
+      for(unsigned int i=0; i<page_sets; i++)
+        for(unsigned int w=NW; w<way_num; w++)
+          page->meta[i*way_num+w]->to_extend();
+    if constexpr (EnMT) {
+      Page *expected = nullptr;
+      if(!pages[s >> PW].compare_exchange_strong(expected, page, std::memory_order_acq_rel)) { // allocated by another thread
+        delete page;
+        return expected;
+      }
+    } else
+      pages[s >> PW] = page;
+    return page;
+  }
+
+  __always_inline Page *touch(uint32_t s) {
+    auto page = read_page(s);
+    return page ? page : alloc_page(s);
+  }
+
+public:
+  static constexpr uint32_t nset = 1ul<<IW;  // number of sets
+
+  CacheArraySparse(unsigned int extra_way = 0)
+    : CacheArrayMTBase<EnMT>(nset), way_num(NW+extra_way), pages(nset >> PW) {}
+
+  virtual ~CacheArraySparse() override {
+    if constexpr (EnMT) for(auto &p : pages) delete p.load();
+    else                for(auto p : pages)  delete p;
+  }
+
+  virtual bool hit(uint64_t addr, uint32_t s, uint32_t *w) const override {
+    auto page = read_page(s);
+    if(!page) return false;
+    auto set_meta = page->meta[(s & page_mask)*way_num];
+    for(unsigned int i=0; i<way_num; i++)
+      if(set_meta[i].match(addr)) {
+        *w = i;
+        return true;
+      }
+    return false;
+  }
+
+  virtual CMMetadataCommon * get_meta(uint32_t s, uint32_t w) override { return touch(s)->meta[(s & page_mask)*way_num + w]; }
+  virtual CMDataBase * get_data(uint32_t s, uint32_t w) override {
+    if constexpr (C_VOID<DT>) return nullptr;
+    else                      return touch(s)->data[(s & page_mask)*NW + w];
+  }
+  virtual bool set_allocated(uint32_t s) const override { return read_page(s) != nullptr; }
+
+  // number of allocated sets
+  uint64_t touched_sets() const {
+    uint64_t rv = 0;
+    for(uint32_t p=0; p<(nset >> PW); p++) if(read_page(p << PW)) rv += page_sets;
+    return rv;
+  }
+};
+
 //////////////// define cache ////////////////////
 
 // base class for a cache
@@ -147,6 +361,7 @@ protected:
   // set-associative: one CacheArrayNorm objects
   // with VC: two CacheArrayNorm objects (one fully associative)
   // skewed: partition number of CacheArrayNorm objects (each as a single cache array)
+  // (CacheArraySoA can replace CacheArrayNorm for metadata with a tag, CacheArraySparse allocates sets on demand)
   // MIRAGE: parition number of CacheArrayNorm (meta only) with one separate CacheArrayNorm for storing data (in derived class)
   std::vector<CacheArrayBase *> arrays;
 
@@ -170,9 +385,11 @@ public:
   }
 
   virtual bool replace(uint64_t addr, uint32_t *ai, uint32_t *s, uint32_t *w, uint16_t prio, unsigned int genre = 0) = 0;
+  virtual bool bypass(uint64_t addr) { return false; } // whether a missing block is not to be allocated (predicted dead), asked on a miss
 
   __always_inline CMMetadataCommon *access(uint32_t ai, uint32_t s, uint32_t w) { return arrays[ai]->get_meta(s, w); }
   __always_inline CMDataBase *get_data(uint32_t ai, uint32_t s, uint32_t w) { return arrays[ai]->get_data(s, w); }
+  __always_inline bool set_allocated(uint32_t ai, uint32_t s) const { return arrays[ai]->set_allocated(s); }
 
   // methods for supporting multithread execution
   virtual CMDataBase *data_copy_buffer() = 0;               // allocate a copy buffer, needed by exclusive cache with extended meta
@@ -200,75 +417,210 @@ public:
   virtual void query_fill_loc(LocInfo *loc, uint64_t addr) = 0;
 };
 
+// a cache with pools of copy buffers
+// MT: metadata type, DT: data type (void if not in use), EnMT: enable multithread
+// MSHR (maximal number of transactions on the fly) buffers of each type are allocated
+template<typename MT, typename DT, bool EnMT>
+  requires C_DERIVE<MT, CMMetadataBase> && C_DERIVE_OR_VOID<DT, CMDataBase>
+class CacheBuffered : public CacheBase
+{
+protected:
+  std::unordered_set<CMDataBase *> data_buffer_pool_set;
+  std::vector<CMDataBase *>        data_buffer_pool;
+  uint16_t                         data_buffer_state;
+  std::mutex                       data_buffer_mutex;
+  std::condition_variable          data_buffer_cv;
+
+  std::unordered_set<CMMetadataBase *> meta_buffer_pool_set;
+  std::vector<CMMetadataBase *>        meta_buffer_pool;
+  uint16_t                             meta_buffer_state;
+  std::mutex                           meta_buffer_mutex;
+  std::condition_variable              meta_buffer_cv;
+
+public:
+  CacheBuffered(std::string name, unsigned int mshr)
+    : CacheBase(name), data_buffer_state(mshr), meta_buffer_pool(mshr, nullptr), meta_buffer_state(mshr)
+  {
+    assert(mshr >= 2 || 0 == "2 buffers are required even for single-thread simulation!");
+    for(auto &b : meta_buffer_pool) { b = new MT(); meta_buffer_pool_set.insert(b); }
+    if constexpr (!C_VOID<DT>) {
+      data_buffer_pool.resize(mshr, nullptr);
+      for(auto &b : data_buffer_pool) { b = new DT(); data_buffer_pool_set.insert(b); }
+    }
+  }
+
+  virtual ~CacheBuffered() override {
+    if (!data_buffer_pool_set.empty()) for(auto b: data_buffer_pool_set) delete b;
+    for(auto b: meta_buffer_pool_set) delete b;
+  }
+
+  virtual CMDataBase *data_copy_buffer() override {
+    if (data_buffer_pool_set.empty()) return nullptr;
+    if constexpr (EnMT) {
+      std::unique_lock lk(data_buffer_mutex);
+      while(data_buffer_state == 0) data_buffer_cv.wait(lk);
+      return data_buffer_pool[--data_buffer_state];
+    } else {
+      assert(data_buffer_state > 0);
+      return data_buffer_pool[--data_buffer_state];
+    }
+  }
+
+  virtual void data_return_buffer(CMDataBase *buf) override {
+    if (!buf) return;
+    if(data_buffer_pool_set.count(buf)) { // only recycle previous allocated buffer
+      if constexpr (EnMT) {
+        {
+          std::lock_guard lk(data_buffer_mutex);
+          data_buffer_pool[data_buffer_state] = buf;
+          data_buffer_state++;
+        }
+        data_buffer_cv.notify_one();
+      } else {
+        data_buffer_pool[data_buffer_state] = buf;
+        data_buffer_state++;
+      }
+    }
+  }
+
+  virtual CMMetadataBase *meta_copy_buffer() override {
+    if (meta_buffer_pool_set.empty()) return nullptr;
+    if constexpr (EnMT) {
+      std::unique_lock lk(meta_buffer_mutex);
+      while(meta_buffer_state == 0) meta_buffer_cv.wait(lk);
+      return meta_buffer_pool[--meta_buffer_state];
+    } else {
+      assert(meta_buffer_state > 0);
+      return meta_buffer_pool[--meta_buffer_state];
+    }
+  }
+
+  virtual void meta_return_buffer(CMMetadataBase *buf) override {
+    if(meta_buffer_pool_set.count(buf)) { // only recycle previous allocated buffer
+      if constexpr (EnMT) {
+        {
+          std::lock_guard lk(meta_buffer_mutex);
+          meta_buffer_pool[meta_buffer_state] = buf;
+          meta_buffer_state++;
+        }
+        meta_buffer_cv.notify_one();
+      } else {
+        meta_buffer_pool[meta_buffer_state] = buf;
+        meta_buffer_state++;
+      }
+    }
+  }
+};
+
 // Skewed Cache
 // IW: index width, NW: number of ways, P: number of partitions
 // MT: metadata type, DT: data type (void if not in use)
 // IDX: indexer type, RPC: replacer type
 // EnMon: whether to enable monitoring
 // EnMT: enable multithread, MSHR: maximal number of transactions on the fly
+// CAT: cache array type
+// MF: miss filter type (void if not in use), e.g. CMCountingBloom<EnMT>, a lookup rejected by the filter
+//     is a miss without indexing and searching any cache array (not for caches relocating lines internally)
+// DBP: dead block predictor type (void if not in use), e.g. DBPredictorSHiP<EnBP, EnMT>, a fill predicted dead is inserted
+//      at the distant priority or, when bypassing is enabled, not allocated at all (not for caches relocating lines internally)
 template<int IW, int NW, int P, typename MT, typename DT, typename IDX, typename RPC, typename DLY,
-         bool EnMon, bool EnMT = false, int MSHR = 4>
+         bool EnMon, bool EnMT = false, int MSHR = 4,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, typename MF = void, typename DBP = void>
   requires C_DERIVE<MT, CMMetadataBase> && C_DERIVE_OR_VOID<DT, CMDataBase> &&
            C_DERIVE<IDX, IndexFuncBase> && C_DERIVE_OR_VOID<DLY, DelayBase> &&
+           C_DERIVE<CAT<IW, NW, MT, DT, EnMT>, CacheArrayBase> &&
            (MSHR >= 2) // 2 buffers are required even for single-thread simulation
-class CacheSkewed : public CacheBase
+class CacheSkewed : public CacheBuffered<MT, DT, EnMT>
 {
 protected:
+  using CacheBase::arrays;
+  typedef CAT<IW, NW, MT, DT, EnMT> CacheArrayT;
+  typedef CacheMonitorImp<DLY, EnMon> CacheMonitorT;
+
   IDX indexer;      // index resolver
   RPC replacer[P];  // replacer
-  RandomGen<uint32_t> * loc_random = nullptr; // a local randomizer for better thread parallelism
+  MF *miss_filter = nullptr; // filter of the addresses in this cache, updated on replace and eviction
+  DBP *dead_pred = nullptr;  // dead block predictor, trained on replace, access and eviction
+  CMRandomLocal<EnMT> loc_random; // a local randomizer
+
+  // memo of the indices of the address in the current transaction of a thread (hashed indexers only),
+  // so an address is hashed at most once by hit(), replace() and the queries of a transaction
+  static constexpr bool EnIM = requires { typename IDX::hasher_type; };
+  struct IndexMemo { uint64_t epoch = 0, addr; uint32_t valid, idx[P]; };
+  static inline std::atomic<uint64_t> index_epoch_next = 1;
+  uint64_t index_epoch; // unique to the current seeds of an indexer, identifies the memo entries of this cache
+
+  // must be called when the indexer is reseeded
+  void index_memo_reset() { index_epoch = index_epoch_next++; }
+
+  __always_inline uint32_t get_index(uint64_t addr, uint32_t ai) {
+    if constexpr (EnIM) {
+      static thread_local IndexMemo memo;
+      if(memo.epoch != index_epoch || memo.addr != addr) { memo.epoch = index_epoch; memo.addr = addr; memo.valid = 0; }
+      if(!(memo.valid & (1u << ai))) { memo.idx[ai] = indexer.index(addr, ai); memo.valid |= 1u << ai; }
+      return memo.idx[ai];
+    } else
+      return indexer.index(addr, ai);
+  }
 
-  std::unordered_set<CMDataBase *> data_buffer_pool_set;
-  std::vector<CMDataBase *>        data_buffer_pool;
-  uint16_t                         data_buffer_state = MSHR;
-  std::mutex                       data_buffer_mutex;
-  std::condition_variable          data_buffer_cv;
-
-  std::unordered_set<CMMetadataBase *> meta_buffer_pool_set;
-  std::vector<CMMetadataBase *>        meta_buffer_pool;
-  uint16_t                             meta_buffer_state = MSHR;
-  std::mutex                           meta_buffer_mutex;
-  std::condition_variable              meta_buffer_cv;
+  // the first P arrays are always CacheArrayT and the monitor container is always CacheMonitorT,
+  // so they are accessed without virtual dispatch
+  __always_inline CacheArrayT *array(uint32_t ai) const { return static_cast<CacheArrayT *>(arrays[ai]); }
+  __always_inline CacheMonitorT *monitor() const { return static_cast<CacheMonitorT *>(this->monitors); }
 
   virtual void replace_choose_set(uint64_t addr, uint32_t *ai, uint32_t *s, unsigned int) {
     if constexpr (P==1) *ai = 0;
-    else                *ai = ((*loc_random)() % P);
-    *s = indexer.index(addr, *ai);
+    else                *ai = loc_random(P);
+    *s = get_index(addr, *ai);
   }
 
 public:
   CacheSkewed(std::string name, unsigned int extra_par = 0, unsigned int extra_way = 0)
-    : CacheBase(name), meta_buffer_pool(MSHR)
+    : CacheBuffered<MT, DT, EnMT>(name, MSHR)
   {
+    if constexpr (EnIM) index_memo_reset();
     arrays.resize(P+extra_par);
-    for(int i=0; i<P; i++) arrays[i] = new CacheArrayNorm<IW,NW,MT,DT,EnMT>(extra_way);
+    for(int i=0; i<P; i++) arrays[i] = new CAT<IW,NW,MT,DT,EnMT>(extra_way);
     CacheMonitorSupport::monitors = new CacheMonitorImp<DLY, EnMon>(CacheBase::id);
 
-    if constexpr (P>1) loc_random = cm_alloc_rand32();
-
-    // allocate buffer pools
-    meta_buffer_pool.resize(MSHR, nullptr);
-    for(auto &b : meta_buffer_pool) { b = new MT(); meta_buffer_pool_set.insert(b); }
-    if constexpr (!C_VOID<DT>) {
-      data_buffer_pool.resize(MSHR, nullptr);
-      for(auto &b : data_buffer_pool) { b = new DT(); data_buffer_pool_set.insert(b); }
-    }
+    if constexpr (!C_VOID<MF>) miss_filter = new MF((1ull<<IW) * NW * P);
+    if constexpr (!C_VOID<DBP>) dead_pred = new DBP(P, 1ul<<IW, NW);
   }
 
   virtual ~CacheSkewed() override {
     delete CacheMonitorSupport::monitors;
-    if (!data_buffer_pool_set.empty()) for(auto b: data_buffer_pool_set) delete b;
-    for(auto b: meta_buffer_pool_set) delete b;
-    if constexpr (P>1) delete loc_random;
+    if constexpr (!C_VOID<MF>) delete miss_filter;
+    if constexpr (!C_VOID<DBP>) delete dead_pred;
   }
 
   virtual std::tuple<int, int, int> size() const override { return std::make_tuple(P, 1ul<<IW, NW); }
 
+  // accuracy of the way prediction (CacheArrayNormWP): <number of hits, number of correctly predicted hits>
+  std::pair<uint64_t, uint64_t> way_pred_stat() const requires requires(const CacheArrayT *a) { a->way_pred_stat(); } {
+    std::pair<uint64_t, uint64_t> rv(0, 0);
+    for(int i=0; i<P; i++) {
+      auto [hit, pred] = array(i)->way_pred_stat();
+      rv.first += hit; rv.second += pred;
+    }
+    return rv;
+  }
+
+  // dead block prediction: <number of fills, number of fills predicted dead, number of bypassed blocks>
+  std::tuple<uint64_t, uint64_t, uint64_t> dead_block_stat() const requires (!C_VOID<DBP>) { return dead_pred->stat(); }
+  void dead_block_stat_reset() requires (!C_VOID<DBP>) { dead_pred->stat_reset(); }
+
+  using CacheBase::hit;
   virtual bool hit(uint64_t addr, uint32_t *ai, uint32_t *s, uint32_t *w, uint16_t prio, bool check_and_set) override {
+    if constexpr (!C_VOID<MF>) {
+      if(!miss_filter->test(addr)) { // a definite miss, ai and s are left as a full search would do
+        *ai = P; *s = get_index(addr, P-1);
+        return false;
+      }
+    }
     for(*ai=0; *ai<P; (*ai)++) {
-      *s = indexer.index(addr, *ai);
+      *s = get_index(addr, *ai);
       if(EnMT && check_and_set) this->set_mt_state(*ai, *s, prio);
-      if(arrays[*ai]->hit(addr, *s, w)) return true;
+      if(array(*ai)->CacheArrayT::hit(addr, *s, w)) return true;
       if(EnMT && check_and_set) this->reset_mt_state(*ai, *s, prio);
     }
     return false;
@@ -293,9 +645,16 @@ public:
       }
     }
     replacer[*ai].replace(*s, w);
+    if constexpr (!C_VOID<MF>) miss_filter->insert(addr); // addr is to be filled in
+    if constexpr (!C_VOID<DBP>) dead_pred->replace(addr, *ai, *s, *w);
     return true;
   }
 
+  virtual bool bypass(uint64_t addr) override {
+    if constexpr (!C_VOID<DBP>) return DBP::bypass_enabled && dead_pred->bypass(addr);
+    else                        return false;
+  }
+
   __always_inline void relocate(uint64_t addr, CMMetadataBase *s_meta, CMMetadataBase *d_meta) {
     d_meta->init(addr);
     d_meta->copy(s_meta);
@@ -325,106 +684,69 @@ public:
   }
 
   __always_inline void swap(uint64_t a_addr, uint64_t b_addr, CMMetadataBase *a_meta, CMMetadataBase *b_meta, CMDataBase *a_data, CMDataBase *b_data) {
-    auto buffer_meta = meta_copy_buffer();
-    auto buffer_data = a_data ? data_copy_buffer() : nullptr;
+    auto buffer_meta = this->meta_copy_buffer();
+    auto buffer_data = a_data ? this->data_copy_buffer() : nullptr;
     relocate(a_addr, a_meta, buffer_meta, a_data, buffer_data);
     relocate(b_addr, b_meta, a_meta, b_data, a_data);
     relocate(a_addr, buffer_meta, b_meta, buffer_data, b_data);
-    meta_return_buffer(buffer_meta);
-    data_return_buffer(buffer_data);
+    this->meta_return_buffer(buffer_meta);
+    this->data_return_buffer(buffer_data);
+  }
+
+  // eviction rank of a way, computed only when an attached monitor reads it
+  __always_inline int32_t ev_rank(uint32_t ai, uint32_t s, uint32_t w) const {
+    return (ai < P && monitor()->need_ev_rank()) ? replacer[ai].eviction_rank(s, w) : -1;
   }
 
   virtual void hook_read(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
-    if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_read(addr, ai, s, w, (ai < P ? replacer[ai].eviction_rank(s, w) : -1), hit, meta, data, delay);
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_read(addr, ai, s, w, ev_rank(ai, s, w), hit, meta, data, delay);
   }
 
   virtual void replace_read(uint32_t ai, uint32_t s, uint32_t w, bool prefetch, bool genre = false) override {
-    if(ai < P) replacer[ai].access(s, w, true, prefetch);
+    if(ai < P) {
+      if constexpr (!C_VOID<DBP>) prefetch |= dead_pred->access(ai, s, w); // a fill predicted dead is inserted as a prefetch
+      replacer[ai].access(s, w, true, prefetch);
+    }
   }
 
   virtual void hook_write(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
-    if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_write(addr, ai, s, w, (ai < P ? replacer[ai].eviction_rank(s, w) : -1), hit, meta, data, delay);
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_write(addr, ai, s, w, ev_rank(ai, s, w), hit, meta, data, delay);
   }
 
-  virtual void replace_write(uint32_t ai, uint32_t s, uint32_t w, bool demand_acc, bool genre = false) override {
-    if(ai < P) replacer[ai].access(s, w, demand_acc, false);
+  virtual void hook_bypass(uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) override {
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_bypass(addr, meta, data, delay);
   }
 
-  virtual void hook_manage(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool writeback, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
-    if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_manage(addr, ai, s, w, (ai < P ? replacer[ai].eviction_rank(s, w) : -1), hit, evict, writeback, meta, data, delay);
-  }
-
-  virtual void replace_manage(uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool genre = false) override {
-    if(ai < P && hit && evict) replacer[ai].invalid(s, w, evict == 2);
-  }
-
-  virtual CMDataBase *data_copy_buffer() override {
-    if (data_buffer_pool_set.empty()) return nullptr;
-    if constexpr (EnMT) {
-      std::unique_lock lk(data_buffer_mutex);
-      while(data_buffer_state == 0) data_buffer_cv.wait(lk);
-      return data_buffer_pool[--data_buffer_state];
-    } else {
-      assert(data_buffer_state > 0);
-      return data_buffer_pool[--data_buffer_state];
-    }
-  }
-
-  virtual void data_return_buffer(CMDataBase *buf) override {
-    if (!buf) return;
-    if(data_buffer_pool_set.count(buf)) { // only recycle previous allocated buffer
-      if constexpr (EnMT) {
-        {
-          std::lock_guard lk(data_buffer_mutex);
-          data_buffer_pool[data_buffer_state] = buf;
-          data_buffer_state++;
-        }
-        data_buffer_cv.notify_one();
-      } else {
-        data_buffer_pool[data_buffer_state] = buf;
-        data_buffer_state++;
-      }
+  virtual void replace_write(uint32_t ai, uint32_t s, uint32_t w, bool demand_acc, bool genre = false) override {
+    if(ai < P) {
+      bool distant = false;
+      if constexpr (!C_VOID<DBP>) if(demand_acc) distant = dead_pred->access(ai, s, w);
+      replacer[ai].access(s, w, demand_acc, distant);
     }
   }
 
-  virtual CMMetadataBase *meta_copy_buffer() override {
-    if (meta_buffer_pool_set.empty()) return nullptr;
-    if constexpr (EnMT) {
-      std::unique_lock lk(meta_buffer_mutex);
-      while(meta_buffer_state == 0) meta_buffer_cv.wait(lk);
-      return meta_buffer_pool[--meta_buffer_state];
-    } else {
-      assert(meta_buffer_state > 0);
-      return meta_buffer_pool[--meta_buffer_state];
-    }
+  virtual void hook_manage(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool writeback, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
+    if constexpr (!C_VOID<MF>) if(ai < P && hit && evict) miss_filter->remove(addr);
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_manage(addr, ai, s, w, ev_rank(ai, s, w), hit, evict, writeback, meta, data, delay);
   }
 
-  virtual void meta_return_buffer(CMMetadataBase *buf) override {
-    if(meta_buffer_pool_set.count(buf)) { // only recycle previous allocated buffer
-      if constexpr (EnMT) {
-        {
-          std::lock_guard lk(meta_buffer_mutex);
-          meta_buffer_pool[meta_buffer_state] = buf;
-          meta_buffer_state++;
-        }
-        meta_buffer_cv.notify_one();
-      } else {
-        meta_buffer_pool[meta_buffer_state] = buf;
-        meta_buffer_state++;
-      }
+  virtual void replace_manage(uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool genre = false) override {
+    if(ai < P && hit && evict) {
+      replacer[ai].invalid(s, w, evict == 2);
+      if constexpr (!C_VOID<DBP>) dead_pred->invalid(ai, s, w);
     }
   }
 
   virtual bool query_coloc(uint64_t addrA, uint64_t addrB) override {
     for(int i=0; i<P; i++) 
-      if(indexer.index(addrA, i) == indexer.index(addrB, i)) 
+      if(get_index(addrA, i) == get_index(addrB, i))
         return true;
     return false;
   }
 
   virtual void query_fill_loc(LocInfo *loc, uint64_t addr) override {
     for(int i=0; i<P; i++){
-      loc->insert(LocIdx(i, indexer.index(addr, i)), LocRange(0, NW-1));
+      loc->insert(LocIdx(i, get_index(addr, i)), LocRange(0, NW-1));
     }
   }
 };
@@ -434,7 +756,20 @@ public:
 // MT: metadata type, DT: data type (void if not in use)
 // IDX: indexer type, RPC: replacer type
 // EnMon: whether to enable monitoring
-template<int IW, int NW, typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon, bool EnMT = false, int MSHR = 4>
-using CacheNorm = CacheSkewed<IW, NW, 1, MT, DT, IDX, RPC, DLY, EnMon, EnMT, MSHR>;
+// CAT: cache array type, MF: miss filter type, DBP: dead block predictor type
+template<int IW, int NW, typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon, bool EnMT = false, int MSHR = 4,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, typename MF = void, typename DBP = void>
+using CacheNorm = CacheSkewed<IW, NW, 1, MT, DT, IDX, RPC, DLY, EnMon, EnMT, MSHR, CAT, MF, DBP>;
+
+// a cache type sealed for static dispatch
+// CT: the cache type to be sealed
+// Coherence ports given the sealed type (their CT parameter) call the cache without virtual dispatch,
+// so the compiler can inline the access path inside a cache. The virtual interface of CacheBase is kept.
+template<typename CT> requires C_DERIVE<CT, CacheBase>
+class CacheStatic final : public CT
+{
+public:
+  using CT::CT;
+};
 
 #endif
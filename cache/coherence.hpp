@@ -46,6 +46,8 @@ public:
   virtual void connect_by_dispatch(CohMasterBase *dispatcher, CohMasterBase *h) = 0;
 
   virtual void acquire_req(uint64_t addr, CMMetadataBase *meta, CMDataBase *data, coh_cmd_t cmd, uint64_t *delay) = 0;
+  // acquire a block this cache does not keep (no-allocate path), the outer neither tracks it nor waits for a finish
+  virtual void acquire_untracked_req(uint64_t addr, CMMetadataBase *meta, CMDataBase *data, coh_cmd_t cmd, uint64_t *delay) = 0;
   virtual void writeback_req(uint64_t addr, CMMetadataBase *meta, CMDataBase *data, coh_cmd_t cmd, uint64_t *delay) = 0;
 
   // may not implement probe_resp() and finish_req() if the port is uncached
@@ -89,9 +91,13 @@ public:
 };
 
 // common behvior for uncached outer ports
-template<class Policy, bool EnMT> requires C_DERIVE<Policy, CohPolicyBase>
+// CT: cache type, calls to the cache are statically dispatched when it is a sealed type (CacheStatic)
+template<class Policy, bool EnMT, typename CT = CacheBase> requires C_DERIVE<Policy, CohPolicyBase> && C_DERIVE<CT, CacheBase>
 class OuterCohPortUncached : public OuterCohPortBase
 {
+protected:
+  __always_inline CT *typed_cache() const { return static_cast<CT *>(cache); }
+
 public:
   virtual void connect(CohMasterBase *h) override { // auto detection of uncached cache
     OuterCohPortBase::coh = h;
@@ -117,7 +123,7 @@ public:
     // use a copy buffer for the outer acquire
     CMMetadataBase * mmeta; CMDataBase * mdata;  // I think allocating data buffer is unnecessary, but play safe for now
     if constexpr (EnMT) {
-      mmeta = cache->meta_copy_buffer(); mdata = data ? cache->data_copy_buffer() : nullptr;
+      mmeta = typed_cache()->meta_copy_buffer(); mdata = data ? typed_cache()->data_copy_buffer() : nullptr;
       mmeta->copy(meta); // some derived cache may store key info inside the meta, such as the data set/way in MIRAGE
       meta->unlock();
     } else {
@@ -129,16 +135,22 @@ public:
     if constexpr (EnMT) {
       meta->lock();
       meta->copy(mmeta); if(data) data->copy(mdata);
-      cache->meta_return_buffer(mmeta); cache->data_return_buffer(mdata);
+      typed_cache()->meta_return_buffer(mmeta); typed_cache()->data_return_buffer(mdata);
     }
 
     Policy::meta_after_fetch(outer_cmd, meta, addr);
   }
 
+  virtual void acquire_untracked_req(uint64_t addr, CMMetadataBase *meta, CMDataBase *data, coh_cmd_t outer_cmd, uint64_t *delay) override {
+    outer_cmd.id = -1; // meta and data are copy buffers private to this transaction
+    coh->acquire_resp(addr, data, meta->get_outer_meta(), outer_cmd, delay);
+    Policy::meta_after_fetch(outer_cmd, meta, addr);
+  }
+
   virtual void writeback_req(uint64_t addr, CMMetadataBase *meta, CMDataBase *data, coh_cmd_t outer_cmd, uint64_t *delay) override {
     outer_cmd.id = coh_id;
-    CMMetadataBase *outer_meta = meta ? meta->get_outer_meta() : nullptr;
-    coh->writeback_resp(addr, data, outer_meta, outer_cmd, delay);
+    if(meta) coh->writeback_resp(addr, data, meta->get_outer_meta(), outer_cmd, delay);
+    else     coh->writeback_resp(addr, data, nullptr, outer_cmd, delay);
     Policy::meta_after_writeback(outer_cmd, meta);
   }
 
@@ -152,7 +164,7 @@ template<template <typename, bool, typename...> class OPUC, typename Policy, boo
 class OuterCohPortT : public OPUC<Policy, EnMT, Extra...>
 {
 protected:
-  using OuterCohPortBase::cache;
+  using OPUC<Policy, EnMT, Extra...>::typed_cache;
   using OuterCohPortBase::coh_id;
 public:
   virtual std::pair<bool,bool> probe_resp(uint64_t addr, CMMetadataBase *meta_outer, CMDataBase *data_outer, coh_cmd_t outer_cmd, uint64_t *delay) override {
@@ -164,19 +176,19 @@ public:
 
     if constexpr (EnMT) {
       while(true) {
-        hit = cache->hit(addr, &ai, &s, &w, XactPrio::probe, true);
+        hit = typed_cache()->hit(addr, &ai, &s, &w, XactPrio::probe, true);
         if(hit) {
-          std::tie(meta, data) = cache->access_line(ai, s, w); meta->lock();
-          if(!cache->check_mt_state(ai, s, XactPrio::probe) || !meta->match(addr)) { // cache line is invalidated potentially by a simultaneous acquire
+          std::tie(meta, data) = typed_cache()->access_line(ai, s, w); meta->lock();
+          if(!typed_cache()->check_mt_state(ai, s, XactPrio::probe) || !meta->match(addr)) { // cache line is invalidated potentially by a simultaneous acquire
             meta->unlock(); meta = nullptr; data = nullptr;
-            cache->reset_mt_state(ai, s, XactPrio::probe); continue; // redo the hit check
+            typed_cache()->reset_mt_state(ai, s, XactPrio::probe); continue; // redo the hit check
           }
         }
         break;
       }
     } else {
-      hit = cache->hit(addr, &ai, &s, &w, 0, false);
-      if(hit) std::tie(meta, data) = cache->access_line(ai, s, w);
+      hit = typed_cache()->hit(addr, &ai, &s, &w, 0, false);
+      if(hit) std::tie(meta, data) = typed_cache()->access_line(ai, s, w);
     }
 
     if(hit) {
@@ -185,8 +197,8 @@ public:
       if(sync.first) {
         auto [phit, pwb] = OuterCohPortBase::inner->probe_req(addr, meta, data, sync.second, delay);
         if(pwb) {
-          cache->replace_write(ai, s, w, false);
-          cache->hook_write(addr, ai, s, w, true, meta, data, delay);
+          typed_cache()->replace_write(ai, s, w, false);
+          typed_cache()->hook_write(addr, ai, s, w, true, meta, data, delay);
         }
       }
 
@@ -194,14 +206,14 @@ public:
       if constexpr (EnMT) {assert(meta->match(addr)); meta_outer->lock(); }
       if((writeback = Policy::probe_need_writeback(outer_cmd, meta))) { if(data_outer) data_outer->copy(data); } // writeback if dirty
       Policy::meta_after_probe(outer_cmd, meta, meta_outer, coh_id, writeback); // alway update meta
-      cache->replace_manage(ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0));
-      cache->hook_manage(addr, ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0), writeback, meta, data, delay);
-      if constexpr (EnMT) { meta_outer->unlock(); meta->unlock(); cache->reset_mt_state(ai, s, XactPrio::probe); }
+      typed_cache()->replace_manage(ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0));
+      typed_cache()->hook_manage(addr, ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0), writeback, meta, data, delay);
+      if constexpr (EnMT) { meta_outer->unlock(); meta->unlock(); typed_cache()->reset_mt_state(ai, s, XactPrio::probe); }
     } else {
       if constexpr (EnMT) meta_outer->lock();
       Policy::meta_after_probe(outer_cmd, meta, meta_outer, coh_id, writeback); // alway update meta
-      cache->replace_manage(ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0));
-      cache->hook_manage(addr, ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0), writeback, meta, data, delay);
+      typed_cache()->replace_manage(ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0));
+      typed_cache()->hook_manage(addr, ai, s, w, hit, (coh::is_evict(outer_cmd) ? 1 : 0), writeback, meta, data, delay);
       if constexpr (EnMT) meta_outer->unlock();
     }
     return std::make_pair(hit, writeback);
@@ -214,21 +226,37 @@ public:
 
 };
 
-template<typename Policy, bool EnMT = false>
-using OuterCohPort = OuterCohPortT<OuterCohPortUncached, Policy, EnMT>;
+template<typename Policy, bool EnMT = false, typename CT = CacheBase>
+using OuterCohPort = OuterCohPortT<OuterCohPortUncached, Policy, EnMT, CT>;
 
-template<typename Policy, bool EnMT> requires C_DERIVE<Policy, CohPolicyBase>
+// common behavior for uncached inner ports
+// CT: cache type, calls to the cache are statically dispatched when it is a sealed type (CacheStatic)
+template<typename Policy, bool EnMT, typename CT = CacheBase> requires C_DERIVE<Policy, CohPolicyBase> && C_DERIVE<CT, CacheBase>
 class InnerCohPortUncached : public InnerCohPortBase
 {
+protected:
+  __always_inline CT *typed_cache() const { return static_cast<CT *>(cache); }
+
 public:
+  // ai returned by access_line() when a read miss bypasses this cache, meta and data are then copy buffers
+  static constexpr uint32_t ai_bypass = ~0u;
+
   virtual void acquire_resp(uint64_t addr, CMDataBase *data_inner, CMMetadataBase *meta_inner, coh_cmd_t cmd, uint64_t *delay) override {
     auto [meta, data, ai, s, w, hit] = access_line(addr, cmd, XactPrio::acquire, delay);
+    if(ai == ai_bypass) { // granted without being allocated, the untracked inner needs no finish
+      if (data_inner && data) data_inner->copy(data);
+      Policy::meta_after_grant(cmd, meta, meta_inner);
+      typed_cache()->hook_bypass(addr, meta, data, delay);
+      typed_cache()->meta_return_buffer(meta);
+      typed_cache()->data_return_buffer(data);
+      return;
+    }
     bool act_as_prefetch = coh::is_prefetch(cmd) && Policy::is_uncached(); // only tweak replace priority at the LLC accoridng to [Guo2022-MICRO]
 
     if (data_inner && data) data_inner->copy(data);
     Policy::meta_after_grant(cmd, meta, meta_inner);
-    if(!act_as_prefetch || !hit) cache->replace_read(ai, s, w, act_as_prefetch);
-    cache->hook_read(addr, ai, s, w, hit, meta, data, delay);
+    if(!act_as_prefetch || !hit) typed_cache()->replace_read(ai, s, w, act_as_prefetch);
+    typed_cache()->hook_read(addr, ai, s, w, hit, meta, data, delay);
     finish_record(addr, coh::cmd_for_finish(cmd.id), !hit, meta, ai, s);
     if(cmd.id == -1) finish_resp(addr, coh::cmd_for_finish(cmd.id));
   }
@@ -242,55 +270,56 @@ public:
 
   virtual void query_loc_resp(uint64_t addr, std::list<LocInfo> *locs) override {
     outer->query_loc_req(addr, locs);
-    locs->push_front(cache->query_loc(addr));
+    locs->push_front(typed_cache()->query_loc(addr));
   }
 
 protected:
   virtual void evict(CMMetadataBase *meta, CMDataBase *data, int32_t ai, uint32_t s, uint32_t w, uint64_t *delay) {
     // evict a block due to conflict
     auto addr = meta->addr(s);
-    assert(cache->hit(addr));
+    assert(typed_cache()->hit(addr));
     auto sync = Policy::writeback_need_sync(meta);
     if(sync.first) {
-      if constexpr (EnMT && Policy::sync_need_lock()) cache->set_mt_state(ai, s, XactPrio::sync);
+      if constexpr (EnMT && Policy::sync_need_lock()) typed_cache()->set_mt_state(ai, s, XactPrio::sync);
       auto [phit, pwb] = probe_req(addr, meta, data, sync.second, delay); // sync if necessary
       if(pwb){
-        cache->replace_write(ai, s, w, false);
-        cache->hook_write(addr, ai, s, w, true, meta, data, delay); // a write occurred during the probe
+        typed_cache()->replace_write(ai, s, w, false);
+        typed_cache()->hook_write(addr, ai, s, w, true, meta, data, delay); // a write occurred during the probe
       }
-      if constexpr (EnMT && Policy::sync_need_lock()) cache->reset_mt_state(ai, s, XactPrio::sync);
+      if constexpr (EnMT && Policy::sync_need_lock()) typed_cache()->reset_mt_state(ai, s, XactPrio::sync);
     }
     auto writeback = Policy::writeback_need_writeback(meta);
     if(writeback.first) outer->writeback_req(addr, meta, data, writeback.second, delay); // writeback if dirty
     Policy::meta_after_evict(meta);
-    cache->replace_manage(ai, s, w, true, 1);
-    cache->hook_manage(addr, ai, s, w, true, 1, writeback.first, meta, data, delay);
+    typed_cache()->replace_manage(ai, s, w, true, 1);
+    typed_cache()->hook_manage(addr, ai, s, w, true, 1, writeback.first, meta, data, delay);
   }
 
   virtual std::tuple<bool, CMMetadataBase *, CMDataBase *, uint32_t, uint32_t, uint32_t>
-  check_hit_or_replace(uint64_t addr, uint16_t prio, bool do_replace, uint64_t *delay) { // check hit or get a replacement target
+  check_hit_or_replace(uint64_t addr, uint16_t prio, bool do_replace, uint64_t *delay, // check hit or get a replacement target
+                       bool may_bypass = false) { // a miss predicted dead is not replaced (meta is nullptr) when may_bypass
     uint32_t ai, s, w;
     CMMetadataBase *meta = nullptr;
     CMDataBase *data = nullptr;
     bool hit;
     if constexpr (EnMT) {
       while(true) {
-        hit = cache->hit(addr, &ai, &s, &w, prio, true);
+        hit = typed_cache()->hit(addr, &ai, &s, &w, prio, true);
         if(hit) {
-          std::tie(meta, data) = cache->access_line(ai, s, w);
+          std::tie(meta, data) = typed_cache()->access_line(ai, s, w);
           meta->lock();
-          if(!cache->check_mt_state(ai, s, prio) || !meta->match(addr)) { // acquire is intercepted by a probe and even invalidated
+          if(!typed_cache()->check_mt_state(ai, s, prio) || !meta->match(addr)) { // acquire is intercepted by a probe and even invalidated
             meta->unlock(); meta = nullptr; data = nullptr;
-            cache->reset_mt_state(ai, s, prio);
+            typed_cache()->reset_mt_state(ai, s, prio);
             continue; // redo the hit check
           }
-        } else if(do_replace) { // miss
-          if(cache->replace(addr, &ai, &s, &w, prio)) { // lock the cache set and get a replacement candidate
-            std::tie(meta, data) = cache->access_line(ai, s, w);
+        } else if(do_replace && !(may_bypass && typed_cache()->bypass(addr))) { // miss
+          if(typed_cache()->replace(addr, &ai, &s, &w, prio)) { // lock the cache set and get a replacement candidate
+            std::tie(meta, data) = typed_cache()->access_line(ai, s, w);
             meta->lock();
-            while(!cache->check_mt_state(ai, s, prio)) { // yield to an active probe
+            while(!typed_cache()->check_mt_state(ai, s, prio)) { // yield to an active probe
               meta->unlock();
-              cache->wait_mt_state(ai, s, prio);
+              typed_cache()->wait_mt_state(ai, s, prio);
               meta->lock();
             }
           } else
@@ -299,26 +328,41 @@ protected:
         break;
       }
     } else {
-      hit = cache->hit(addr, &ai, &s, &w, 0, false);
-      if(!hit && do_replace) cache->replace(addr, &ai, &s, &w, prio);
-      if(hit || do_replace)  std::tie(meta, data) = cache->access_line(ai, s, w);
+      hit = typed_cache()->hit(addr, &ai, &s, &w, 0, false);
+      if(!hit && do_replace && may_bypass && typed_cache()->bypass(addr)) do_replace = false;
+      if(!hit && do_replace) typed_cache()->replace(addr, &ai, &s, &w, prio);
+      if(hit || do_replace)  std::tie(meta, data) = typed_cache()->access_line(ai, s, w);
     }
     return std::make_tuple(hit, meta, data, ai, s, w);
   }
 
+  // no-allocate path for a missing block: fetch it into copy buffers without allocating it in this cache,
+  // the caller grants the block and returns the buffers
+  std::pair<CMMetadataBase *, CMDataBase *> bypass_line(uint64_t addr, coh_cmd_t cmd, uint64_t *delay) {
+    auto meta = typed_cache()->meta_copy_buffer(); meta->init(addr); meta->get_outer_meta()->to_invalid();
+    auto data = typed_cache()->data_copy_buffer();
+    outer->acquire_untracked_req(addr, meta, data, Policy::cmd_for_outer_acquire(cmd), delay);
+    return std::make_pair(meta, data);
+  }
+
+  // a read from an inner not tracked by this cache (never probed) or from the core may bypass a block predicted dead
   virtual std::tuple<CMMetadataBase *, CMDataBase *, uint32_t, uint32_t, uint32_t, bool>
   access_line(uint64_t addr, coh_cmd_t cmd, uint16_t prio, uint64_t *delay) { // common function for access a line in the cache
-    auto [hit, meta, data, ai, s, w] = check_hit_or_replace(addr, prio, true, delay);
+    auto [hit, meta, data, ai, s, w] = check_hit_or_replace(addr, prio, true, delay, cmd.id == -1 && coh::is_fetch_read(cmd));
+    if(!hit && !meta) { // bypass
+      std::tie(meta, data) = bypass_line(addr, cmd, delay);
+      return std::make_tuple(meta, data, ai_bypass, s, w, hit);
+    }
     if(hit) {
       auto sync = Policy::access_need_sync(cmd, meta);
       if(sync.first) {
-        if constexpr (EnMT && Policy::sync_need_lock()) { assert(prio < XactPrio::sync); cache->set_mt_state(ai, s, XactPrio::sync);}
+        if constexpr (EnMT && Policy::sync_need_lock()) { assert(prio < XactPrio::sync); typed_cache()->set_mt_state(ai, s, XactPrio::sync);}
         auto [phit, pwb] = probe_req(addr, meta, data, sync.second, delay); // sync if necessary
         if(pwb){
-          cache->replace_write(ai, s, w, false);
-          cache->hook_write(addr, ai, s, w, true, meta, data, delay); // a write occurred during the probe
+          typed_cache()->replace_write(ai, s, w, false);
+          typed_cache()->hook_write(addr, ai, s, w, true, meta, data, delay); // a write occurred during the probe
         }
-        if constexpr (EnMT && Policy::sync_need_lock()) cache->reset_mt_state(ai, s, XactPrio::sync);
+        if constexpr (EnMT && Policy::sync_need_lock()) typed_cache()->reset_mt_state(ai, s, XactPrio::sync);
       }
       auto [promote, promote_local, promote_cmd] = Policy::access_need_promote(cmd, meta);
       if(promote) { outer->acquire_req(addr, meta, data, promote_cmd, delay); hit = false; } // promote permission if needed
@@ -336,9 +380,9 @@ protected:
     if(data_inner) data->copy(data_inner);
     Policy::meta_after_release(cmd, meta, meta_inner);
     assert(meta_inner); // assume meta_inner is valid for all writebacks
-    cache->replace_write(ai, s, w, false);
-    cache->hook_write(addr, ai, s, w, hit, meta, data, delay);
-    if constexpr (EnMT) { meta->unlock(); cache->reset_mt_state(ai, s, XactPrio::release); }
+    typed_cache()->replace_write(ai, s, w, false);
+    typed_cache()->hook_write(addr, ai, s, w, hit, meta, data, delay);
+    if constexpr (EnMT) { meta->unlock(); typed_cache()->reset_mt_state(ai, s, XactPrio::release); }
   }
 
   virtual void flush_line(uint64_t addr, coh_cmd_t cmd, uint64_t *delay) {
@@ -350,23 +394,23 @@ protected:
       if(!hit) return;
 
       if(probe) {
-        if constexpr (EnMT && Policy::sync_need_lock()) cache->set_mt_state(ai, s, XactPrio::sync);
+        if constexpr (EnMT && Policy::sync_need_lock()) typed_cache()->set_mt_state(ai, s, XactPrio::sync);
         auto [phit, pwb] = probe_req(addr, meta, data, probe_cmd, delay); // sync if necessary
         if(pwb){
-          cache->replace_write(ai, s, w, false); // a write occurred during the probe
-          cache->hook_write(addr, ai, s, w, true, meta, data, delay); // a write occurred during the probe
+          typed_cache()->replace_write(ai, s, w, false); // a write occurred during the probe
+          typed_cache()->hook_write(addr, ai, s, w, true, meta, data, delay); // a write occurred during the probe
         }
-        if constexpr (EnMT && Policy::sync_need_lock()) cache->reset_mt_state(ai, s, XactPrio::sync);
+        if constexpr (EnMT && Policy::sync_need_lock()) typed_cache()->reset_mt_state(ai, s, XactPrio::sync);
       }
 
       auto writeback = Policy::writeback_need_writeback(meta);
       if(writeback.first) outer->writeback_req(addr, meta, data, writeback.second, delay); // writeback if dirty
 
       Policy::meta_after_flush(cmd, meta, cache);
-      cache->replace_manage(ai, s, w, hit, (coh::is_evict(cmd) ? 2 : 0)); // identify flush to hook_manager
-      cache->hook_manage(addr, ai, s, w, hit, (coh::is_evict(cmd) ? 2 : 0), writeback.first, meta, data, delay); // identify flush to hook_manager
+      typed_cache()->replace_manage(ai, s, w, hit, (coh::is_evict(cmd) ? 2 : 0)); // identify flush to hook_manager
+      typed_cache()->hook_manage(addr, ai, s, w, hit, (coh::is_evict(cmd) ? 2 : 0), writeback.first, meta, data, delay); // identify flush to hook_manager
 
-      if constexpr (EnMT) { meta->unlock(); cache->reset_mt_state(ai, s, XactPrio::flush); }
+      if constexpr (EnMT) { meta->unlock(); typed_cache()->reset_mt_state(ai, s, XactPrio::flush); }
     }
   }
 
@@ -415,13 +459,18 @@ public:
   }
 };
 
-template<typename Policy, bool EnMT = false>
-using InnerCohPort = InnerCohPortT<InnerCohPortUncached, Policy, EnMT>;
+template<typename Policy, bool EnMT = false, typename CT = CacheBase>
+using InnerCohPort = InnerCohPortT<InnerCohPortUncached, Policy, EnMT, CT>;
 
 // base class for CoreInterface
 class CoreInterfaceBase
 {
+protected:
+  const uint64_t blk_mask; // clear the block offset of an address
+
 public:
+  CoreInterfaceBase(unsigned int blk_ofst = 6) : blk_mask(~((1ull << blk_ofst) - 1)) {}
+
   virtual const CMDataBase *read(uint64_t addr, uint64_t *delay) = 0;
   
   virtual void write(uint64_t addr, const CMDataBase *m_data, uint64_t *delay) = 0;
@@ -439,30 +488,40 @@ public:
 
   virtual void query_loc(uint64_t addr, std::list<LocInfo> *locs) = 0;
 
-  __always_inline uint64_t normalize(uint64_t addr) const { return addr & ~0x3full; }
+  __always_inline uint64_t normalize(uint64_t addr) const { return addr & blk_mask; }
 };
 
 // interface with the processing core is a special InnerCohPort
-template<typename Policy, bool EnMT = false>
-class CoreInterface : public InnerCohPortUncached<Policy, EnMT>, public CoreInterfaceBase {
-  typedef InnerCohPortUncached<Policy, EnMT> BaseT;
-  using BaseT::cache;
+// BlkOfst: block offset, log2 of the block size
+template<typename Policy, bool EnMT = false, typename CT = CacheBase, int BlkOfst = 6>
+class CoreInterface : public InnerCohPortUncached<Policy, EnMT, CT>, public CoreInterfaceBase {
+  typedef InnerCohPortUncached<Policy, EnMT, CT> BaseT;
+  using BaseT::typed_cache;
   using BaseT::outer;
 
+  CMDataBase *bypass_data = nullptr; // copy buffer holding the data of the last bypassed read, kept until the next access
+
   virtual const CMDataBase *read_write_access(uint64_t addr, const CMDataBase *m_data, const coh_cmd_t cmd, uint64_t *delay) {
     addr = normalize(addr);
+    if(bypass_data) { typed_cache()->data_return_buffer(bypass_data); bypass_data = nullptr; }
     auto [meta, data, ai, s, w, hit] = this->access_line(addr, cmd, XactPrio::acquire, delay);
+    if(ai == BaseT::ai_bypass) { // the caller reads the returned data, so the buffer is returned by the next access
+      typed_cache()->hook_bypass(addr, meta, data, delay);
+      typed_cache()->meta_return_buffer(meta);
+      bypass_data = data;
+      return data;
+    }
     if(coh::is_write(cmd)) {
       meta->to_dirty();
       if(data) data->copy(m_data);
-      cache->replace_write(ai, s, w, true);
-      cache->hook_write(addr, ai, s, w, hit, meta, data, delay);
+      typed_cache()->replace_write(ai, s, w, true);
+      typed_cache()->hook_write(addr, ai, s, w, hit, meta, data, delay);
     } else {
       bool act_as_prefetch = coh::is_prefetch(cmd) && Policy::is_uncached(); // only tweak replace priority at the LLC accoridng to [Guo2022-MICRO]
-      if(!act_as_prefetch || !hit) cache->replace_read(ai, s, w, act_as_prefetch);
-      cache->hook_read(addr, ai, s, w, hit, meta, data, delay);
+      if(!act_as_prefetch || !hit) typed_cache()->replace_read(ai, s, w, act_as_prefetch);
+      typed_cache()->hook_read(addr, ai, s, w, hit, meta, data, delay);
     }
-    if constexpr (EnMT) { meta->unlock(); cache->reset_mt_state(ai, s, XactPrio::acquire);}
+    if constexpr (EnMT) { meta->unlock(); typed_cache()->reset_mt_state(ai, s, XactPrio::acquire);}
     if(!hit) outer->finish_req(addr);
 #ifdef CHECK_MULTI
     if constexpr (EnMT) { global_lock_checker->check(); }
@@ -471,7 +530,7 @@ class CoreInterface : public InnerCohPortUncached<Policy, EnMT>, public CoreInte
   }
 
 public:
-  using BaseT::BaseT;
+  CoreInterface() : CoreInterfaceBase(BlkOfst) {}
 
   virtual const CMDataBase *read(uint64_t addr, uint64_t *delay) override { return read_write_access(addr, nullptr, coh::cmd_for_read(), delay); }
   virtual void write(uint64_t addr, const CMDataBase *m_data, uint64_t *delay) override { read_write_access(addr, m_data, coh::cmd_for_write(), delay); }
@@ -481,11 +540,12 @@ public:
   virtual const CMDataBase *prefetch(uint64_t addr, uint64_t *delay) override { return read_write_access(addr, nullptr, coh::cmd_for_prefetch(), delay); }
 
   virtual void flush_cache(uint64_t *delay) override {
-    auto [npar, nset, nway] = cache->size();
+    auto [npar, nset, nway] = typed_cache()->size();
     for(int ipar=0; ipar<npar; ipar++)
-      for(int iset=0; iset < nset; iset++)
+      for(int iset=0; iset < nset; iset++) {
+        if(!typed_cache()->set_allocated(ipar, iset)) continue; // never allocated (sparse arrays), nothing to flush
         for(int iway=0; iway < nway; iway++) {
-          auto [meta, data] = cache->access_line(ipar, iset, iway);
+          auto [meta, data] = typed_cache()->access_line(ipar, iset, iway);
           if constexpr (EnMT) meta->lock();
           if(meta->is_valid()) {
             auto addr = meta->addr(iset);
@@ -495,12 +555,13 @@ public:
             if constexpr (EnMT) meta->unlock();
           }
         }
+      }
   }
 
   virtual void query_loc(uint64_t addr, std::list<LocInfo> *locs) override {
     addr = normalize(addr);
     outer->query_loc_req(addr, locs);
-    locs->push_front(cache->query_loc(addr));
+    locs->push_front(typed_cache()->query_loc(addr));
   }
 
 private:
@@ -551,8 +612,10 @@ template<typename CacheT, typename OuterT, class InnerT>
 class CoherentCacheNorm : public CoherentCacheBase
 {
 public:
-  CoherentCacheNorm(std::string name = "")
-    : CoherentCacheBase(new CacheT(name), new OuterT, new InnerT, name) {}
+  // args: extra arguments to construct the cache (e.g. the geometry of a CacheSkewedRT)
+  template<typename... Args>
+  CoherentCacheNorm(std::string name = "", const Args&... args)
+    : CoherentCacheBase(new CacheT(name, args...), new OuterT, new InnerT, name) {}
 };
 
 /////////////////////////////////
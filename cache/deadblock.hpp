@@ -0,0 +1,115 @@
+#ifndef CM_CACHE_DEADBLOCK_HPP
+#define CM_CACHE_DEADBLOCK_HPP
+
+// dead block prediction, used to insert at the distant priority or bypass the blocks unlikely to be reused in a cache
+
+#include <atomic>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "util/alloc.hpp"
+#include "util/random.hpp"
+
+// Signature-based hit predictor (SHiP) with signatures of memory regions (SHiP-Mem)
+// EnBP: bypass (do not allocate) a missing block predicted dead when the inner port allows it
+// EnMT: the predictor is updated by concurrent threads (racy, an update may be lost, which only costs accuracy)
+// SW: width of a signature (2^SW counters in the signature history counter table, SHCT)
+// RS: log2 of the region size, the blocks of a region share a signature
+// SMP: only 1 in 2^SMP sets train the SHCT (set sampling), 0 to train on all sets
+// A line records the signature of its block on a fill. The counter of a signature is incremented on the first reuse
+// of a line and decremented when a line is replaced without any reuse, a block with a zero counter is predicted dead.
+// A fill predicted dead is inserted at the distant priority, and 1 in 32 missing blocks predicted dead are
+// still allocated by a bypassing cache, so the SHCT learns a signature turning live.
+template<bool EnBP, bool EnMT, int SW = 14, int RS = 14, int SMP = 0> requires (SW > 0 && SW <= 16 && SMP >= 0)
+class DBPredictorSHiP
+{
+  template<typename T> using C_CNT = std::conditional_t<EnMT, std::atomic<T>, T>;
+  static constexpr uint8_t cnt_max = 7;  // 3-bit counters
+  static constexpr uint8_t cnt_init = 1; // weakly live
+  static constexpr uint32_t sig_mask = (1u << SW) - 1;
+  static constexpr uint32_t fill = 1u << 28, dead = 1u << 29, reused = 1u << 30, valid = 1u << 31; // state of a line
+
+  const uint32_t nset, nway;
+  std::vector<C_CNT<uint8_t> > shct;  // signature history counter table
+  CMLazyRows<uint32_t, 1, EnMT> line; // signature and state of each line, pages are zeroed on the first touch
+  C_CNT<uint64_t> cnt_fill = 0, cnt_dead = 0, cnt_bypass = 0;
+
+  template<typename T> static __always_inline T load(const std::atomic<T> &v) { return v.load(std::memory_order_relaxed); }
+  template<typename T> static __always_inline T load(const T &v) { return v; }
+  template<typename T> static __always_inline void store(std::atomic<T> &v, T d) { v.store(d, std::memory_order_relaxed); }
+  template<typename T> static __always_inline void store(T &v, T d) { v = d; }
+
+  __always_inline uint32_t signature(uint64_t addr) const { return ((addr >> RS) * 0x9e3779b97f4a7c15ull) >> (64 - SW); }
+  __always_inline bool sampled(uint32_t s) const { return (s & ((1u << SMP) - 1)) == 0; }
+  // a line is a plain word in lazily initialized pages, accessed atomically when EnMT
+  __always_inline uint32_t *entry(uint32_t ai, uint32_t s, uint32_t w) { return line[(ai*nset + s)*nway + w]; }
+  static __always_inline uint32_t line_load(const uint32_t *e) {
+    if constexpr (EnMT) return __atomic_load_n(e, __ATOMIC_RELAXED);
+    else                return *e;
+  }
+  static __always_inline void line_store(uint32_t *e, uint32_t v) {
+    if constexpr (EnMT) __atomic_store_n(e, v, __ATOMIC_RELAXED);
+    else                *e = v;
+  }
+  __always_inline bool predict_dead(uint32_t sig) const { return load(shct[sig]) == 0; }
+
+  __always_inline void train(uint32_t sig, bool live) {
+    uint8_t v = load(shct[sig]);
+    if(live && v < cnt_max) store(shct[sig], (uint8_t)(v+1));
+    if(!live && v > 0)      store(shct[sig], (uint8_t)(v-1));
+  }
+
+public:
+  static constexpr bool bypass_enabled = EnBP;
+
+  DBPredictorSHiP(uint32_t npar, uint32_t nset, uint32_t nway)
+    : nset(nset), nway(nway), shct(1ul << SW), line(npar * nset * nway)
+  {
+    for(auto &c : shct) store(c, cnt_init);
+  }
+
+  // whether a missing block is not to be allocated
+  bool bypass(uint64_t addr) {
+    if constexpr (EnBP) {
+      if(predict_dead(signature(addr)) && cm_random()(32)) { cnt_bypass++; return true; }
+    }
+    return false;
+  }
+
+  // a block is to be filled in way w of set s (partition ai), replacing the block therein
+  void replace(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w) {
+    auto e = entry(ai, s, w);
+    uint32_t v = line_load(e);
+    if((v & valid) && !(v & reused) && sampled(s)) train(v & sig_mask, false);
+    uint32_t sig = signature(addr);
+    bool d = predict_dead(sig);
+    cnt_fill++; if(d) cnt_dead++;
+    line_store(e, valid | fill | (d ? dead : 0) | sig);
+  }
+
+  // a demand access to way w, return true if it fills a block predicted dead (to be inserted at the distant priority)
+  bool access(uint32_t ai, uint32_t s, uint32_t w) {
+    auto e = entry(ai, s, w);
+    uint32_t v = line_load(e);
+    if(!(v & valid)) return false;
+    if(v & fill) { line_store(e, v & ~fill); return v & dead; }
+    if(!(v & reused)) {
+      line_store(e, v | reused);
+      if(sampled(s)) train(v & sig_mask, true);
+    }
+    return false;
+  }
+
+  // way w is invalidated (evicted, probed or flushed), the replacement of a line being filled is trained by replace()
+  void invalid(uint32_t ai, uint32_t s, uint32_t w) {
+    auto e = entry(ai, s, w);
+    if(!(line_load(e) & fill)) line_store(e, 0);
+  }
+
+  // <number of fills, number of fills predicted dead, number of bypassed blocks>
+  std::tuple<uint64_t, uint64_t, uint64_t> stat() const { return std::make_tuple(load(cnt_fill), load(cnt_dead), load(cnt_bypass)); }
+  void stat_reset() { store(cnt_fill, (uint64_t)0); store(cnt_dead, (uint64_t)0); store(cnt_bypass, (uint64_t)0); }
+};
+
+#endif
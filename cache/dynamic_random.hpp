@@ -18,10 +18,11 @@ struct RemapHelper {
 // MT: metadata type, DT: data type (void if not in use)
 // IDX: indexer type, RPC: replacer type
 // EnMon: whether to enable monitoring
-template<int IW, int NW, int P, typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon>
+// BO: block offset width of the indexer
+template<int IW, int NW, int P, typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon, int BO = 6>
   requires C_DERIVE<MT, CMMetadataBase> 
         && C_DERIVE_OR_VOID<DT, CMDataBase>
-        && C_DERIVE<IDX, IndexSkewed<IW, 6, P>>
+        && C_DERIVE<IDX, IndexSkewed<IW, BO, P, typename IDX::hasher_type>>
         && C_DERIVE_OR_VOID<DLY, DelayBase>
 class CacheRemap : public CacheSkewed<IW, NW, P, MT, DT, IDX, RPC, DLY, EnMon>, protected RemapHelper
 {
@@ -40,8 +41,8 @@ protected:
 
   virtual void replace_choose_set(uint64_t addr, uint32_t *ai, uint32_t *s, unsigned int genre) override {
     if constexpr (P==1) *ai = 0;
-    else                *ai = ((*loc_random)() % P);
-    if(0 == genre) *s = indexer.index(addr, *ai);
+    else                *ai = loc_random(P);
+    if(0 == genre) *s = this->get_index(addr, *ai);
     else if(replace_for_relocate == genre) *s = indexer_next.index(addr, *ai);
     else {
       assert(replace_during_remap == genre);
@@ -62,6 +63,7 @@ public:
 
   void rotate_indexer() {
     indexer.seed(indexer_seed_next);
+    this->index_memo_reset();
     std::generate(indexer_seed_next.begin(), indexer_seed_next.end(), cm_get_random_uint64);
     indexer_next.seed(indexer_seed_next);
   }
@@ -69,7 +71,7 @@ public:
   virtual bool hit(uint64_t addr, uint32_t *ai, uint32_t *s, uint32_t *w, uint16_t prio, bool check_and_set) override {
     if(!remap) return CacheT::hit(addr, ai, s, w, prio, check_and_set);
     for(*ai=0; *ai<P; (*ai)++) {
-      *s = indexer.index(addr, *ai);
+      *s = this->get_index(addr, *ai);
       if(*s >= remap_pointer[*ai]){
         if (arrays[*ai]->hit(addr, *s, w)) return true;
       }
@@ -104,13 +104,14 @@ struct ExclusiveMESIPolicy : public ExclusiveMSIPolicy<isL1, uncached, Outer, En
 // IDX: indexer type, RPC: replacer type, DRPC: directory replacer type(if use direcotry)
 // EnMon: whether to enable monitoring
 // EnDir: whether to enable use directory
-template<int IW, int NW, int DW, int P, typename MT, typename DT, typename IDX, typename RPC, typename DRPC, typename DLY, bool EnMon, bool EnDir>
+// CAT: cache array type
+template<int IW, int NW, int DW, int P, typename MT, typename DT, typename IDX, typename RPC, typename DRPC, typename DLY, bool EnMon, bool EnDir,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm>
   requires (!EnDir || DW > 0)
-class CacheSkewedExclusive : public CacheSkewed<IW, NW, P, MT, DT, IDX, RPC, DLY, EnMon>
+class CacheSkewedExclusive : public CacheSkewed<IW, NW, P, MT, DT, IDX, RPC, DLY, EnMon, false, 4, CAT>
 {
-  typedef CacheSkewed<IW, NW, P, MT, DT, IDX, RPC, DLY, EnMon> CacheT;
+  typedef CacheSkewed<IW, NW, P, MT, DT, IDX, RPC, DLY, EnMon, false, 4, CAT> CacheT;
   using CacheT::indexer;
-  using CacheT::loc_random;
   using CacheT::replacer;
   using CacheMonitorSupport::monitors;
 protected:
@@ -127,11 +128,15 @@ public:
     return true; // ToDo: support multithread
   }
 
+  // eviction rank of a way, computed only when an attached monitor reads it
+  __always_inline int32_t ev_rank(uint32_t ai, uint32_t s, uint32_t w) const {
+    if(!monitors->need_ev_rank()) return -1;
+    return w >= NW ? ext_replacer[ai].eviction_rank(s, w-NW) : replacer[ai].eviction_rank(s, w);
+  }
+
   virtual void hook_read(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) override {
     if(ai < P) {
-      if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_read(addr, ai, s, w,
-                                                               (w >= NW ? ext_replacer[ai].eviction_rank(s, w-NW) : replacer[ai].eviction_rank(s, w)),
-                                                               hit, meta, data, delay);
+      if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_read(addr, ai, s, w, ev_rank(ai, s, w), hit, meta, data, delay);
     } else {
       if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_read(addr, -1, -1, -1, -1, hit, meta, data, delay);
     }
@@ -146,9 +151,7 @@ public:
 
   virtual void hook_write(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) override {
     if(ai < P) {
-      if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_write(addr, ai, s, w,
-                                                                (w >= NW ? ext_replacer[ai].eviction_rank(s, w-NW) : replacer[ai].eviction_rank(s, w)),
-                                                                hit, meta, data, delay);
+      if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_write(addr, ai, s, w, ev_rank(ai, s, w), hit, meta, data, delay);
     } else {
       if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_write(addr, -1, -1, -1, -1, hit, meta, data, delay);
     }
@@ -163,9 +166,7 @@ public:
 
   virtual void hook_manage(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool writeback, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) override {
     if(ai < P){
-      if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_manage(addr, ai, s, w,
-                                                                (w >= NW ? ext_replacer[ai].eviction_rank(s, w-NW) : replacer[ai].eviction_rank(s, w)),
-                                                                hit, evict, writeback, meta, data, delay);
+      if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_manage(addr, ai, s, w, ev_rank(ai, s, w), hit, evict, writeback, meta, data, delay);
     } else {
       if constexpr (EnMon || !C_VOID<DLY>) monitors->hook_manage(addr, -1, -1, -1, -1, hit, evict, writeback, meta, data, delay);
     }
@@ -186,9 +187,10 @@ public:
 // MT: metadata type, DT: data type (void if not in use)
 // IDX: indexer type, RPC: replacer type,
 // EnMon: whether to enable monitoring
-// EnDir: whether to enable use directory
-template<int IW, int NW, typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon>
-using CacheNormExclusiveBroadcast = CacheSkewedExclusive<IW, NW, 0, 1, MT, DT, IDX, RPC, ReplaceRandom<1,1,true,true,false>, DLY, EnMon, false>;
+// CAT: cache array type
+template<int IW, int NW, typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm>
+using CacheNormExclusiveBroadcast = CacheSkewedExclusive<IW, NW, 0, 1, MT, DT, IDX, RPC, ReplaceRandom<1,1,true,true,false>, DLY, EnMon, false, CAT>;
 
 template<typename Policy, bool EnMT>
 class ExclusiveInnerCohPortUncachedBroadcast : public InnerCohPortUncached<Policy, EnMT>
@@ -362,8 +364,10 @@ using ExclusiveInnerCohPortBroadcast = InnerCohPortT<ExclusiveInnerCohPortUncach
 // MT: metadata type, DT: data type (void if not in use)
 // IDX: indexer type, RPC: replacer type, DRPC: directory replacer type(if use direcotry)
 // EnMon: whether to enable monitoring
-template<int IW, int NW, int DW, typename MT, typename DT, typename IDX, typename RPC, typename DRPC, typename DLY, bool EnMon>
-using CacheNormExclusiveDirectory = CacheSkewedExclusive<IW, NW, DW, 1, MT, DT, IDX, RPC, DRPC, DLY, EnMon, true>;
+// CAT: cache array type
+template<int IW, int NW, int DW, typename MT, typename DT, typename IDX, typename RPC, typename DRPC, typename DLY, bool EnMon,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm>
+using CacheNormExclusiveDirectory = CacheSkewedExclusive<IW, NW, DW, 1, MT, DT, IDX, RPC, DRPC, DLY, EnMon, true, CAT>;
 
 template<typename Policy, bool EnMT>
 class ExclusiveInnerCohPortUncachedDirectory : public InnerCohPortUncached<Policy, EnMT>
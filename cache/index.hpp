@@ -1,9 +1,11 @@
 #ifndef CM_INDEX_HPP_
 #define CM_INDEX_HPP_
 
+#include<cassert>
 #include<vector>
 
 #include "util/random.hpp"
+#include "util/fastmod.hpp"
 
 /////////////////////////////////
 // Base class
@@ -11,9 +13,37 @@ class IndexFuncBase
 {
 protected: 
   const uint32_t mask;
+  const int npar; // number of partitions
+
+  // idx[i] = hasher(addr[i] >> ofst) & mask, using the batch interface of the hasher if it has one
+  template<typename HT>
+  __always_inline void hash_batch(HT &hasher, const uint64_t *addr, uint32_t *idx, unsigned int n, int ofst) const {
+    if constexpr (requires(const uint64_t *d, uint64_t *r) { hasher(d, r, n); }) {
+      constexpr unsigned int B = 64;
+      uint64_t buf[B];
+      for(unsigned int i=0; i<n; i+=B) {
+        unsigned int m = n - i < B ? n - i : B;
+        cm_map_u64v(addr+i, buf, m, [ofst](auto v) { return v >> ofst; });
+        hasher(buf, buf, m);
+        cm_map_u64v(buf, idx+i, m, [this](auto v) { return v & mask; });
+      }
+    } else
+      for(unsigned int i=0; i<n; i++) idx[i] = hasher(addr[i] >> ofst) & mask;
+  }
+
 public:
-  IndexFuncBase(uint32_t mask) : mask(mask) {}
+  IndexFuncBase(uint32_t mask, int npar = 1) : mask(mask), npar(npar) {}
   virtual uint32_t index(uint64_t addr, int partition) = 0;
+
+  // indices of n addresses in a partition
+  virtual void index_batch(const uint64_t *addr, uint32_t *idx, unsigned int n, int partition) {
+    for(unsigned int i=0; i<n; i++) idx[i] = index(addr[i], partition);
+  }
+
+  // indices of n addresses in all partitions, idx[p*n + i] is the index of addr[i] in partition p
+  void index_all(const uint64_t *addr, uint32_t *idx, unsigned int n) {
+    for(int p=0; p<npar; p++) index_batch(addr, idx + p*n, n, p);
+  }
 };
 
 
@@ -29,32 +59,136 @@ public:
   virtual uint32_t index(uint64_t addr, int partition) override {
     return (addr >> IOfst) & mask;
   }
+
+  virtual void index_batch(const uint64_t *addr, uint32_t *idx, unsigned int n, int) override {
+    cm_map_u64v(addr, idx, n, [this](auto v) { return (v >> IOfst) & mask; });
+  }
 };
 
 /////////////////////////////////
 // Skewed cache
 //   IW: index width, IOfst: index offset, P: number of partitions
-template<int IW, int IOfst, int P>
+//   HT: hasher type (CMHasher, CMHasherSip13, CMHasherMix, CMPrince)
+template<int IW, int IOfst, int P, typename HT = CMHasher>
 class IndexSkewed : public IndexFuncBase
 {
-  CMHasher hashers[P];
+  HT hashers[P];
 public:
-  IndexSkewed() : IndexFuncBase((1ul << IW) - 1) {}
+  typedef HT hasher_type;
+
+  IndexSkewed() : IndexFuncBase((1ul << IW) - 1, P) {}
 
   virtual uint32_t index(uint64_t addr, int partition) override {
     return (hashers[partition](addr >> IOfst)) & mask;
   }
 
+  virtual void index_batch(const uint64_t *addr, uint32_t *idx, unsigned int n, int partition) override {
+    hash_batch(hashers[partition], addr, idx, n, IOfst);
+  }
+
   void seed(std::vector<uint64_t>& seeds) {
     for(int i=0; i<P; i++) hashers[i].seed(seeds[i]);
   }
 };
 
+/////////////////////////////////
+// Skewed cache indexed by a low-latency block cipher (PRINCE) as modelled by CEASER/ScatterCache/MIRAGE,
+// each partition has its own key
+//   IW: index width, IOfst: index offset, P: number of partitions
+template<int IW, int IOfst, int P>
+using IndexPrince = IndexSkewed<IW, IOfst, P, CMPrince>;
+
 /////////////////////////////////
 // Set-associative random cache
-//   IW: index width, IOfst: index offset
-template<int IW, int IOfst>
-using IndexRandom = IndexSkewed<IW,IOfst,1>;
+//   IW: index width, IOfst: index offset, HT: hasher type
+template<int IW, int IOfst, typename HT = CMHasher>
+using IndexRandom = IndexSkewed<IW,IOfst,1,HT>;
+
+
+/////////////////////////////////
+// Indexers with the number of sets decided at run time
+//   IOfst: index offset
+//   constructed with the number of sets (nset) and the number of partitions (p)
+
+// set associative caches, nset must be a power of two
+template<int IOfst>
+class IndexNormRT : public IndexFuncBase
+{
+public:
+  IndexNormRT(uint32_t nset, int) : IndexFuncBase(nset - 1) {
+    assert((nset & (nset - 1)) == 0 || 0 == "IndexNormRT requires a power-of-two number of sets, use IndexModuloRT!");
+  }
+
+  virtual uint32_t index(uint64_t addr, int partition) override {
+    return (addr >> IOfst) & mask;
+  }
+
+  virtual void index_batch(const uint64_t *addr, uint32_t *idx, unsigned int n, int) override {
+    cm_map_u64v(addr, idx, n, [this](auto v) { return (v >> IOfst) & mask; });
+  }
+};
+
+// skewed caches, p: number of partitions, HT: hasher type
+template<int IOfst, typename HT = CMHasher>
+class IndexSkewedRT : public IndexFuncBase
+{
+  std::vector<HT> hashers;
+public:
+  typedef HT hasher_type;
+
+  IndexSkewedRT(uint32_t nset, int p) : IndexFuncBase(nset - 1, p), hashers(p) {
+    assert((nset & (nset - 1)) == 0 || 0 == "IndexSkewedRT requires a power-of-two number of sets, use IndexSkewedModuloRT!");
+  }
+
+  virtual uint32_t index(uint64_t addr, int partition) override {
+    return (hashers[partition](addr >> IOfst)) & mask;
+  }
+
+  virtual void index_batch(const uint64_t *addr, uint32_t *idx, unsigned int n, int partition) override {
+    hash_batch(hashers[partition], addr, idx, n, IOfst);
+  }
+
+  void seed(std::vector<uint64_t>& seeds) {
+    for(unsigned int i=0; i<hashers.size(); i++) hashers[i].seed(seeds[i]);
+  }
+};
+
+// Indexers for a number of sets not being a power of two (e.g. 12 or 20 ways of a 1.5 or 2.5MB slice)
+// The index is a remainder rather than the lower address bits, so the metadata must keep the whole line address (IW = 0).
+// They are only provided for the caches with a run-time geometry (CacheSkewedRT), whose arrays and replacers have exactly nset sets.
+
+// set associative caches with any number of sets
+template<int IOfst>
+class IndexModuloRT : public IndexFuncBase
+{
+  const CMFastMod mod;
+public:
+  IndexModuloRT(uint32_t nset, int) : IndexFuncBase(nset - 1), mod(nset) {}
+
+  virtual uint32_t index(uint64_t addr, int partition) override {
+    return mod(addr >> IOfst);
+  }
+};
+
+// skewed caches with any number of sets
+template<int IOfst, typename HT = CMHasher>
+class IndexSkewedModuloRT : public IndexFuncBase
+{
+  std::vector<HT> hashers;
+  const CMFastMod mod;
+public:
+  typedef HT hasher_type;
+
+  IndexSkewedModuloRT(uint32_t nset, int p) : IndexFuncBase(nset - 1, p), hashers(p), mod(nset) {}
+
+  virtual uint32_t index(uint64_t addr, int partition) override {
+    return mod(hashers[partition](addr >> IOfst));
+  }
+
+  void seed(std::vector<uint64_t>& seeds) {
+    for(unsigned int i=0; i<hashers.size(); i++) hashers[i].seed(seeds[i]);
+  }
+};
 
 
 #endif
@@ -3,7 +3,7 @@
 
 #include "cache/mi.hpp"
 #include "cache/coherence.hpp"
-#include <sys/mman.h>
+#include "util/alloc.hpp"
 #include <unordered_map>
 #include <shared_mutex>
 
@@ -47,6 +47,9 @@ protected:
   const uint32_t id;                    // a unique id to identify this memory
   const std::string name;
   std::unordered_map<uint64_t, char *> pages;
+  // the simulated memory is often sparse, so it is allocated in huge pages only when explicitly requested
+  const unsigned int page_shift = cm_huge_page_policy() == CMHugePage::hugetlb ? 21 : 12;
+  const uint64_t page_mask = (1ull << page_shift) - 1;
   DLY *timer;      // delay estimator
   std::shared_mutex         page_mtx;
 
@@ -60,8 +63,7 @@ protected:
     }
 
     if (miss) {
-      page = static_cast<char *>(mmap(NULL, 4096, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, 0, 0));
-      assert(page != MAP_FAILED);
+      page = static_cast<char *>(cm_alloc_block(1ull << page_shift));
       pages[ppn] = page;
     } else
       page = pages[ppn];
@@ -86,6 +88,7 @@ public:
 
   virtual ~SimpleMemoryModel() override {
     delete monitors;
+    for(auto &p : pages) cm_free_block(p.second, 1ull << page_shift);
   }
 
   virtual void acquire_resp(uint64_t addr, CMDataBase *data_inner, CMMetadataBase *meta_inner, coh_cmd_t cmd, uint64_t *delay) override {
@@ -93,8 +96,8 @@ public:
     if constexpr (EnMT) active_addr_add(addr);
 #endif
     if constexpr (!C_VOID<DT>) {
-      auto ppn = addr >> 12;
-      auto offset = addr & 0x0fffull;
+      auto ppn = addr >> page_shift;
+      auto offset = addr & page_mask;
       char * page;
       if(!get_page(ppn, &page)) page = allocate(ppn);
       uint64_t *mem_addr = reinterpret_cast<uint64_t *>(page + offset);
@@ -112,12 +115,12 @@ public:
     if constexpr (EnMT) active_addr_add(addr);
 #endif
     if constexpr (!C_VOID<DT>) {
-      auto ppn = addr >> 12;
-      auto offset = addr & 0x0fffull;
+      auto ppn = addr >> page_shift;
+      auto offset = addr & page_mask;
       char * page;
       bool hit = get_page(ppn, &page); assert(hit);
       uint64_t *mem_addr = reinterpret_cast<uint64_t *>(page + offset);
-      for(int i=0; i<8; i++) mem_addr[i] = data_inner->read(i);
+      for(unsigned int i=0; i<cm_data_block_size<DT>()/8; i++) mem_addr[i] = data_inner->read(i);
     }
     hook_write(addr, 0, 0, 0, true, meta_inner, data_inner, delay);
 #ifdef CHECK_MULTI
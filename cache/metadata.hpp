@@ -1,6 +1,7 @@
 #ifndef CM_CACHE_METADATA_HPP
 #define CM_CACHE_METADATA_HPP
 
+#include <cassert>
 #include <string>
 #include <boost/format.hpp>
 #include "util/concept_macro.hpp"
@@ -19,29 +20,46 @@ public:
   virtual std::string to_string() const = 0;
 };
 
-// typical 64B data block
-class Data64B : public CMDataBase
+// data block of BS bytes (e.g. 32B, the typical 64B, 128B or a 256B sector)
+template<unsigned int BS> requires (BS >= 8 && (BS & (BS - 1)) == 0)
+class DataBlock : public CMDataBase
 {
 protected:
-  uint64_t data[8] = {0};
+  static constexpr unsigned int NW = BS / 8; // number of 64b words
+  uint64_t data[NW] = {0};
 
 public:
+  static constexpr unsigned int block_size = BS;
+
   virtual void reset() override { for(auto &d:data) d = 0; }
   virtual uint64_t read(unsigned int index) const override { return data[index]; }
   virtual void write(unsigned int index, uint64_t wdata, uint64_t wmask) override { data[index] = (data[index] & (~wmask)) | (wdata & wmask); }
-  virtual void write(uint64_t *wdata) override { for(int i=0; i<8; i++) data[i] = wdata[i]; }
+  virtual void write(uint64_t *wdata) override { for(unsigned int i=0; i<NW; i++) data[i] = wdata[i]; }
 
   virtual void copy(const CMDataBase *m_block) override {
-    auto block = static_cast<const Data64B *>(m_block);
-    for(int i=0; i<8; i++) data[i] = block->data[i];
+    auto block = static_cast<const DataBlock *>(m_block);
+    for(unsigned int i=0; i<NW; i++) data[i] = block->data[i];
   }
 
   virtual std::string to_string() const override {
-    return (boost::format("%016x %016x %016x %016x %016x %016x %016x %016x")
-            % data[0] % data[1] % data[2] % data[3] % data[4] % data[5] % data[6] % data[7]).str();
+    std::string rv;
+    for(unsigned int i=0; i<NW; i++) rv += (boost::format(i ? " %016x" : "%016x") % data[i]).str();
+    return rv;
   }
 };
 
+typedef DataBlock<32>  Data32B;
+typedef DataBlock<64>  Data64B;
+typedef DataBlock<128> Data128B;
+typedef DataBlock<256> Data256B;
+
+// block size (in bytes) of a data type, 64B if it is void or does not tell
+template<typename DT>
+constexpr unsigned int cm_data_block_size() {
+  if constexpr (requires { DT::block_size; }) return DT::block_size;
+  else                                        return 64;
+}
+
 // a common base between data metadata and normal coherence metadata
 class CMMetadataCommon
 {
@@ -57,22 +75,33 @@ public:
   virtual void unlock() {}
 };
 
+class CMOuterMeta;
+
 // base class for all metadata supporting coherence
 // assuming the minimal coherence protocol is MI
 class CMMetadataBase : public CMMetadataCommon
 {
+  friend class CMOuterMeta;
+
 protected:
-  unsigned int state     : 3;
-  unsigned int dirty     : 1; // 0: clean, 1: dirty
-  unsigned int extend    : 1; // 0: cache meta, 1: extend directory meta
+  // all state bits are packed in one 64-bit word, the spare bits are used by derived metadata to store the tag, etc.
+  uint64_t state     : 3;
+  uint64_t dirty     : 1;  // 0: clean, 1: dirty
+  uint64_t extend    : 1;  // 0: cache meta, 1: extend directory meta
+  uint64_t packed    : 59; // spare bits for derived metadata, never touched by copy()
+
 public:
+  static constexpr unsigned int packed_width = 59;
+  static constexpr unsigned int packed_relocate_bit = packed_width - 1; // reserved for MetadataWithRelocate
+  static constexpr unsigned int packed_outer_bit = packed_relocate_bit - 4; // state and dirty of the outer metadata (MetadataMixer)
+
   static const unsigned int state_invalid   = 0; // 000 invalid
   static const unsigned int state_shared    = 1; // 001 clean, shared
   static const unsigned int state_modified  = 6; // 100 may dirty, exclusive
   static const unsigned int state_exclusive = 4; // 110 clean, exclusive
   static const unsigned int state_owned     = 2; // 010 may dirty, shared
 
-  CMMetadataBase() : state(0), dirty(0), extend(0) {}
+  CMMetadataBase() : state(0), dirty(0), extend(0), packed(0) {}
 
   // implement a totally useless base class
   virtual bool match(uint64_t addr) const override { return false; } // wether an address match with this block
@@ -101,8 +130,15 @@ public:
   virtual bool evict_need_probe(int32_t target_id, int32_t request_id) const { return target_id != request_id; }
   virtual bool writeback_need_probe(int32_t target_id, int32_t request_id) const { return target_id != request_id; }
 
-  virtual CMMetadataBase * get_outer_meta() { return nullptr; } // return the outer metadata if supported
-  virtual const CMMetadataBase * get_outer_meta() const { return nullptr; }
+  // the outer metadata if supported (converted to nullptr otherwise), a temporary which must not outlive the expression using it
+  CMOuterMeta get_outer_meta();
+  virtual bool has_outer() const { return false; }
+
+  // the state (3 bits) and the dirty bit of the outer metadata packed in the spare bits
+  __always_inline uint32_t outer_state() const { return (packed >> packed_outer_bit) & 0x7; }
+  __always_inline bool outer_dirty() const { return (packed >> (packed_outer_bit + 3)) & 0x1; }
+  __always_inline void set_outer_state(uint32_t s) { packed = (packed & ~(0x7ull << packed_outer_bit)) | ((uint64_t)s << packed_outer_bit); }
+  __always_inline void set_outer_dirty(bool d) { packed = (packed & ~(0x8ull << packed_outer_bit)) | ((uint64_t)d << (packed_outer_bit + 3)); }
 
   virtual std::string to_string() const {
     std::string str_state; str_state.reserve(16);
@@ -124,6 +160,38 @@ public:
   }
 };
 
+// the outer metadata of a line (see MetadataMixer), an accessor of the outer state packed in the line
+// it is handed to the outer cache as the inner metadata of a transaction (e.g. acquire_resp(..., meta->get_outer_meta(), ...)),
+// the state is loaded when it is created and every change is written back to the line at once
+class CMOuterMeta final : public CMMetadataBase
+{
+  CMMetadataBase *line;
+
+  __always_inline void store_state() { line->set_outer_state(state); }
+  __always_inline void store_dirty() { line->set_outer_dirty(dirty); }
+
+public:
+  explicit CMOuterMeta(CMMetadataBase *line) : line(line) {
+    if(line) { state = line->outer_state(); dirty = line->outer_dirty(); }
+  }
+  CMOuterMeta(const CMOuterMeta &) = delete;
+  CMOuterMeta &operator=(const CMOuterMeta &) = delete;
+
+  __always_inline CMOuterMeta *operator->() { assert(line); return this; }
+  __always_inline operator CMMetadataBase *() { return line ? this : nullptr; }
+
+  virtual void to_invalid() override { CMMetadataBase::to_invalid(); store_state(); store_dirty(); }
+  virtual void to_shared(int32_t coh_id) override { CMMetadataBase::to_shared(coh_id); store_state(); }
+  virtual void to_modified(int32_t coh_id) override { CMMetadataBase::to_modified(coh_id); store_state(); }
+  virtual void to_exclusive(int32_t coh_id) override { CMMetadataBase::to_exclusive(coh_id); store_state(); }
+  virtual void to_owned(int32_t coh_id) override { CMMetadataBase::to_owned(coh_id); store_state(); }
+  virtual void to_dirty() override { CMMetadataBase::to_dirty(); store_dirty(); }
+  virtual void to_clean() override { CMMetadataBase::to_clean(); store_dirty(); }
+  virtual void copy(const CMMetadataBase *meta) override { CMMetadataBase::copy(meta); store_state(); store_dirty(); }
+};
+
+inline CMOuterMeta CMMetadataBase::get_outer_meta() { return CMOuterMeta(has_outer() ? this : nullptr); }
+
 typedef CMMetadataBase MetadataBroadcastBase;
 
 class MetadataDirectoryBase : public MetadataBroadcastBase
@@ -170,27 +238,30 @@ public:
 // TOfst : tag offset
 // MT    : metadata type
 // OutMT : the metadata type to store outer cache state
-template <int AW, int IW, int TOfst, typename MT> requires C_DERIVE<MT, CMMetadataBase>
+// The tag and the outer state are packed with the coherence state in the spare bits of CMMetadataBase,
+// a line is 16B for broadcast (vptr and the packed word) and 24B for directory (plus the sharer vector).
+// The outer metadata, which records only the S/M/E/O state and the dirty bit seen by the outer, is reached through
+// CMOuterMeta, while whether the block is shared by inner caches, the directory, etc. are hold by the metadata.
+template <int AW, int IW, int TOfst, typename MT> requires C_DERIVE<MT, CMMetadataBase> && (AW - TOfst <= CMMetadataBase::packed_outer_bit)
 class MetadataMixer : public MT
 {
 protected:
-  uint64_t     tag = 0;
   constexpr static uint64_t mask = (1ull << (AW-TOfst)) - 1;
-  CMMetadataBase outer_meta; // maintain a copy of metadata for hierarchical coherence support
-                             // this outer metadata is responsible only to record the S/M/E/O state seen by the outer
-                             // whether the block is dirty, shared by inner caches, and directory, etc. are hold by the metadata
 
 public:
-  virtual CMMetadataBase * get_outer_meta() override { return &outer_meta; }
-  virtual const CMMetadataBase * get_outer_meta() const override { return &outer_meta; }
+  virtual bool has_outer() const override { return true; }
 
-  virtual bool match(uint64_t addr) const override { return MT::is_valid() && ((addr >> TOfst) & mask) == tag; }
+  static __always_inline uint64_t tag_of(uint64_t addr) { return (addr >> TOfst) & mask; } // the tag of an address
+  __always_inline uint64_t get_tag() const { return CMMetadataBase::packed & mask; }
+  __always_inline void set_tag(uint64_t tag) { CMMetadataBase::packed = (CMMetadataBase::packed & ~mask) | tag; }
+
+  virtual bool match(uint64_t addr) const override { return MT::is_valid() && tag_of(addr) == get_tag(); }
   virtual void init(uint64_t addr) override {
-    tag = (addr >> TOfst) & mask;
+    set_tag(tag_of(addr));
     CMMetadataBase::state = 0;
   }
   virtual uint64_t addr(uint32_t s) const {
-    uint64_t addr = tag << TOfst;
+    uint64_t addr = get_tag() << TOfst;
     if constexpr (IW > 0) {
       constexpr uint64_t index_mask = (1ull << IW) - 1;
       addr |= (s & index_mask) << (TOfst - IW);
@@ -199,16 +270,17 @@ public:
   }
   virtual void sync(int32_t coh_id) override {}
 
-  virtual void to_invalid() override { MT::to_invalid(); outer_meta.to_invalid(); }
-  virtual void to_dirty() override { outer_meta.to_dirty(); } // directly use the outer meta so the dirty state is release to outer when evicted
-  virtual void to_clean() override { outer_meta.to_clean(); }
-  virtual bool is_dirty() const override { return outer_meta.is_dirty(); }
-  virtual bool allow_write() const override {return outer_meta.allow_write(); }
+  virtual void to_invalid() override { MT::to_invalid(); CMMetadataBase::set_outer_state(0); CMMetadataBase::set_outer_dirty(false); }
+  virtual void to_dirty() override { CMMetadataBase::set_outer_dirty(true); } // directly use the outer meta so the dirty state is release to outer when evicted
+  virtual void to_clean() override { CMMetadataBase::set_outer_dirty(false); }
+  virtual bool is_dirty() const override { return CMMetadataBase::outer_dirty(); }
+  virtual bool allow_write() const override {return 0 != (CMMetadataBase::outer_state() & 0x4); }
 
   virtual void copy(const CMMetadataBase *m_meta) override {
     // ATTN! tag is not coped.
     MT::copy(m_meta);
-    outer_meta.copy(m_meta->get_outer_meta());
+    CMMetadataBase::set_outer_state(m_meta->outer_state());
+    CMMetadataBase::set_outer_dirty(m_meta->outer_dirty());
   }
 };
 
@@ -218,22 +290,43 @@ using MetadataBroadcast = MetadataMixer<AW, IW, TOfst, MT>;
 template <int AW, int IW, int TOfst, typename MT> requires C_DERIVE<MT, MetadataDirectoryBase>
 using MetadataDirectory = MetadataMixer<AW, IW, TOfst, MT>;
 
+static_assert(sizeof(MetadataBroadcast<48, 6, 12, MetadataBroadcastBase>) == 16, "the size of a broadcast line has grown!");
+static_assert(sizeof(MetadataDirectory<48, 6, 12, MetadataDirectoryBase>) == 24, "the size of a directory line has grown!");
+
 // support a relocated bit in the metadata for dynamic remap randomized caches
+// the bit is packed in the spare bits of CMMetadataBase
 template<typename MT> requires C_DERIVE<MT, CMMetadataBase>
 class MetadataWithRelocate : public MT
 {
-protected:
-  bool relocated = false;
+  constexpr static uint64_t relocated = 1ull << CMMetadataBase::packed_relocate_bit;
 public:
-  __always_inline void to_relocated()   { relocated = true;  }
-  __always_inline void to_unrelocated() { relocated = false; }
-  __always_inline bool is_relocated()   { return relocated;  }
+  __always_inline void to_relocated()   { CMMetadataBase::packed |= relocated;  }
+  __always_inline void to_unrelocated() { CMMetadataBase::packed &= ~relocated; }
+  __always_inline bool is_relocated()   { return CMMetadataBase::packed & relocated; }
+};
+
+// A wrapper for mirroring the tag of a metadata into an external tag store (see CacheArraySoA)
+// the tag is only updated when the metadata is initialized, so a mirrored tag is a hint which must be confirmed by match()
+template <typename MT> requires C_DERIVE<MT, CMMetadataBase>
+class MetaTagMirror final : public MT {
+  uint64_t *tag_slot = nullptr;
+
+public:
+  static constexpr uint64_t no_tag = ~0ull; // never equal to a tag as tags are shorter than 64 bits
+
+  __always_inline void bind_tag(uint64_t *slot) { tag_slot = slot; *tag_slot = no_tag; }
+
+  virtual void init(uint64_t addr) override {
+    MT::init(addr);
+    *tag_slot = MT::tag_of(addr);
+  }
 };
 
 // A wrapper for implementing the multithread required cache line lock utility
+// the lock is a 4B spin lock yielding to other threads when held, as a std::mutex (40B) would more than double a line
 template <typename MT> requires C_DERIVE<MT, CMMetadataCommon>
 class MetaLock : public MT {
-  std::mutex mtx;
+  std::atomic<uint32_t> mtx = 0;
 
 #ifdef CHECK_MULTI
   // verify no double lock or unlock
@@ -247,7 +340,8 @@ public:
     assert(locked.load() != thread_id || 0 ==
             "This cache line has already be locked by this thread and should not be locked by this thread again!");
 #endif
-    mtx.lock();
+    while(mtx.exchange(1, std::memory_order_acquire))
+      while(mtx.load(std::memory_order_relaxed)) std::this_thread::yield();
 #ifdef CHECK_MULTI
     global_lock_checker->push(this);
     locked = thread_id;
@@ -262,7 +356,7 @@ public:
     locked = 0;
     global_lock_checker->pop(this);
 #endif
-    mtx.unlock();
+    mtx.store(0, std::memory_order_release);
   }
 };
 
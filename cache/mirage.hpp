@@ -99,20 +99,20 @@ protected:
   virtual void replace_choose_set(uint64_t addr, uint32_t *ai, uint32_t *s, unsigned int genre) override {
     if(replace_for_relocate == genre){
       *ai = next_ai(*ai);
-      *s = indexer.index(addr, *ai);
+      *s = this->get_index(addr, *ai);
       return;
     }
     int max_free = -1, p = 0;
     std::vector<std::pair<uint32_t, uint32_t> > candidates(P);
     uint32_t m_s;
     for(int i=0; i<P; i++) {
-      m_s = indexer.index(addr, i);
+      m_s = this->get_index(addr, i);
       int free_num = replacer[i].get_free_num(m_s);
       if(free_num > max_free) { p = 0; max_free = free_num; }
       if(free_num >= max_free)
         candidates[p++] = std::make_pair(i, m_s);
     }
-    std::tie(*ai, *s) = candidates[(*loc_random)() % p];
+    std::tie(*ai, *s) = candidates[loc_random(p)];
   }
 
 public:
@@ -159,7 +159,7 @@ public:
 
   __always_inline std::pair<uint32_t, uint32_t> replace_data(uint64_t addr) {
     uint32_t d_s, d_w;
-    d_s =  (*loc_random)() % (1ul << IW);
+    d_s = loc_random(1ul << IW);
     d_replacer.replace(d_s, &d_w, false);
     return std::make_pair(d_s, d_w);
   }
@@ -189,7 +189,7 @@ public:
   }
 
   bool pre_finish_reloc(uint64_t addr, uint32_t s_ai, uint32_t s_s, uint32_t ai){
-    return (s_ai == next_ai(ai)) && (s_s == indexer.index(addr, next_ai(ai)));
+    return (s_ai == next_ai(ai)) && (s_s == this->get_index(addr, next_ai(ai)));
   }
 
 };
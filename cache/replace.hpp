@@ -1,11 +1,17 @@
 #ifndef CM_REPLACE_HPP_
 #define CM_REPLACE_HPP_
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <cassert>
 #include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include "util/random.hpp"
 #include "util/multithread.hpp"
+#include "util/alloc.hpp"
 
 #include <version>
 #ifdef __cpp_lib_bitops
@@ -13,16 +19,142 @@
 #include <bit>
 #endif
 
+///////////////////////////////////
+// Interface of all replacers (used when the replacer type is decided at run time)
+class ReplaceBase
+{
+public:
+  virtual ~ReplaceBase() = default;
+  virtual void replace(uint32_t s, uint32_t *w, bool empty_fill_rt = true) = 0;
+  virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) = 0;
+  virtual void invalid(uint32_t s, uint32_t w, bool flush = false) = 0;
+  virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const = 0;
+};
+
+///////////////////////////////////
+// Packed replacement state of NW ways per set
+// A way takes one byte holding a value less than 128 (e.g. an LRU rank or an RRPV), the ways of a set are packed
+// 8 to a 64-bit word and a set is padded to a power-of-two size (at most 64B) so it never crosses a cache line.
+// The ways of a set are compared and updated a word (8 ways) at a time (SWAR).
+// EnMT: every word is updated by a lock-free compare-and-swap, so concurrent updates to a set are never lost,
+//       but the ways held in different words may be updated out of order (a rank may be skipped for a while).
+template<int NW, bool EnMT> requires (NW <= 64)
+class ReplaceState
+{
+  static constexpr int NWD = (NW + 7) / 8; // number of words holding ways
+  static constexpr int RW = NWD <= 1 ? 1 : NWD <= 2 ? 2 : NWD <= 4 ? 4 : 8; // number of words per set
+  static constexpr uint64_t L = 0x0101010101010101ull, H = L << 7;
+
+  CMLazyRows<uint64_t, RW, EnMT> rows; // allocated when a set is touched
+  std::array<uint64_t, RW> init_row = {0};
+
+  // the lanes of word i holding ways
+  static constexpr uint64_t valid(int i) {
+    return NW - 8*i >= 8 ? ~0ull : (1ull << 8*(NW - 8*i)) - 1;
+  }
+
+  // the high bit of the lanes with a >= b
+  static __always_inline uint64_t ge(uint64_t a, uint64_t b) { return ((a | H) - b) & H; }
+
+  // the high bit of the lanes with a == b
+  static __always_inline uint64_t eq(uint64_t a, uint64_t b) { return ~(((a ^ b) | H) - L) & H; }
+
+  static __always_inline uint64_t load(const uint64_t &word) { return cm_load_word<EnMT>(word); }
+
+public:
+  ReplaceState(uint32_t nset) : rows(nset) {}
+
+  // set the initial value of a way, must be called before any set is touched
+  void set_init(int w, uint8_t v) {
+    init_row[w/8] = (init_row[w/8] & ~(0xffull << 8*(w%8))) | ((uint64_t)v << 8*(w%8));
+    rows.set_init(w/8, init_row[w/8]);
+  }
+
+  __always_inline uint32_t get(uint32_t s, uint32_t w) const {
+    return (load(rows[s][w/8]) >> 8*(w%8)) & 0xff;
+  }
+
+  __always_inline void set(uint32_t s, uint32_t w, uint8_t v) {
+    cm_update_word<EnMT>(rows[s][w/8], [w, v](uint64_t word) {
+      return (word & ~(0xffull << 8*(w%8))) | ((uint64_t)v << 8*(w%8));
+    });
+  }
+
+  // decrement the ways with a value larger than v
+  __always_inline void dec_above(uint32_t s, uint32_t v) {
+    auto row = rows[s];
+    for(int i=0; i<NWD; i++)
+      cm_update_word<EnMT>(row[i], [i, v](uint64_t word) { return word - ((ge(word, L*(v+1)) & valid(i)) >> 7); });
+  }
+
+  // increment the ways with a value smaller than v
+  __always_inline void inc_below(uint32_t s, uint32_t v) {
+    auto row = rows[s];
+    for(int i=0; i<NWD; i++)
+      cm_update_word<EnMT>(row[i], [i, v](uint64_t word) { return word + ((~ge(word, L*v) & H & valid(i)) >> 7); });
+  }
+
+  // add d to all ways, saturating at m
+  __always_inline void add(uint32_t s, uint32_t d, uint32_t m) {
+    auto row = rows[s];
+    for(int i=0; i<NWD; i++)
+      cm_update_word<EnMT>(row[i], [i, d, m](uint64_t word) {
+        word += L*d & valid(i);
+        uint64_t over = (ge(word, L*(m+1)) >> 7) * 0xff; // lanes larger than m
+        return (word & ~over) | (L*m & over);
+      });
+  }
+
+  // the first way with the value v, -1 if none
+  __always_inline int32_t find(uint32_t s, uint32_t v) const {
+    auto row = rows[s];
+    for(int i=0; i<NWD; i++)
+      if(auto m = eq(load(row[i]), L*v) & valid(i)) return 8*i + __builtin_ctzll(m) / 8;
+    return -1;
+  }
+
+  // whether any way has a value no smaller than v
+  __always_inline bool any_ge(uint32_t s, uint32_t v) const {
+    auto row = rows[s];
+    uint64_t m = 0;
+    for(int i=0; i<NWD; i++) m |= ge(load(row[i]), L*v) & valid(i);
+    return m;
+  }
+
+  // number of the ways with a value larger than that of way w, or equal but placed before w
+  __always_inline uint32_t rank(uint32_t s, uint32_t w) const {
+    auto row = rows[s];
+    uint64_t v = get(s, w);
+    uint32_t rv = 0;
+    for(int i=0; i<NWD; i++) {
+      uint64_t word = load(row[i]);
+      uint64_t before = 8*i + 8 <= (int)w ? ~0ull : 8*i >= (int)w ? 0 : (1ull << 8*(w - 8*i)) - 1;
+      rv += __builtin_popcountll((ge(word, L*(v+1)) | (eq(word, L*v) & before)) & valid(i));
+    }
+    return rv;
+  }
+};
+
 ///////////////////////////////////
 // Base class
 // EF: empty first, EnMT: multithread
 template<bool EF, int NW, bool EnMT> requires (NW <= 64)
-class ReplaceFuncBase
+class ReplaceFuncBase : public ReplaceBase
 {
+  typedef std::conditional_t<EnMT, std::atomic<uint64_t>, uint64_t> free_map_t;
+
+  // EnMT: the free maps of the 8 sets sharing a cache line are fm_stride sets apart,
+  //       so neighbouring (and often concurrently accessed) sets do not falsely share a cache line
+  const uint32_t fm_stride;
+  CMArena<free_map_t> free_map_arena; // a bit map of the free ways of each set
+
+  __always_inline free_map_t &free_map(uint32_t s) {
+    if constexpr (EnMT) return *free_map_arena[(s & 7) * fm_stride + (s >> 3)];
+    else                return *free_map_arena[s];
+  }
+
 protected:
-  std::vector<std::vector<uint32_t> > used_map; // at the size of 16, vector is actually faster than list and do not require alloc
-  std::vector<uint64_t> free_map_st;            // free map when single thread
-  std::vector<std::atomic<uint64_t> *> free_map_mt; // multi-thread version
+  ReplaceState<NW, EnMT> used_map;              // replace state of each set
   std::vector<int32_t> alloc_map; // record the way allocated for the next access (only one allocated ay at any time)
 
 #ifdef CHECK_MULTI
@@ -33,47 +165,32 @@ protected:
   #endif
 #endif
 
+  // take the first free way, -1 if none
   __always_inline int32_t alloc_from_free(uint32_t s) {
-    while(true) {
-      auto fmap = EnMT ? free_map_mt[s]->load() : free_map_st[s];
-      if(fmap) {
-        auto way_oh = fmap & (~fmap + 1ull);
-        if constexpr (EnMT) {
-          if(!free_map_mt[s]->compare_exchange_strong(fmap, fmap & ~way_oh)) continue;
-        } else {
-          free_map_st[s] &= ~way_oh;
-        }
-        for(int i=0; i<64; i++) if(way_oh == (1ull << i)) return i;
-        assert(0 == "replacer free_map corrupted!");
-        return -1;
-      } else
-        return -1;
+    auto &fm = free_map(s);
+    uint64_t fmap;
+    if constexpr (EnMT) {
+      fmap = fm.load();
+      while(fmap && !fm.compare_exchange_weak(fmap, fmap & (fmap - 1)));
+    } else {
+      fmap = fm;
+      fm &= fmap - 1;
     }
+    return fmap ? __builtin_ctzll(fmap) : -1;
   }
 
   virtual uint32_t select(uint32_t s) = 0;
 
   __always_inline void delist_from_free(uint32_t s, uint32_t w) {
-    uint64_t way_oh = 1ull << w;
-    if constexpr (EnMT) {
-      while(true) {
-        auto fmap = free_map_mt[s]->load();
-        if(0 == (fmap & way_oh)) return;
-        if(free_map_mt[s]->compare_exchange_strong(fmap, fmap & ~way_oh)) return;
-      }
-    } else
-      free_map_st[s] &= ~way_oh;
+    auto &fm = free_map(s);
+    if constexpr (EnMT) { if(fm.load() & (1ull << w)) fm.fetch_and(~(1ull << w)); }
+    else                fm &= ~(1ull << w);
   }
 
   __always_inline void list_to_free(uint32_t s, uint32_t w) {
-    uint64_t way_oh = 1ull << w;
-    if constexpr (EnMT) {
-      while(true) {
-        auto fmap = free_map_mt[s]->load();
-        if(free_map_mt[s]->compare_exchange_strong(fmap, fmap | way_oh)) return;
-      }
-    } else
-      free_map_st[s] |= way_oh;
+    auto &fm = free_map(s);
+    if constexpr (EnMT) fm.fetch_or(1ull << w);
+    else                fm |= 1ull << w;
   }
 
   __always_inline void set_alloc_map(uint32_t s, int32_t v) {
@@ -117,7 +234,7 @@ protected:
 
 public:
   ReplaceFuncBase(uint32_t nset)
-    :used_map(nset), free_map_st(nset), free_map_mt(nset, nullptr), alloc_map(nset, -1) {
+    : fm_stride((nset + 7) / 8), free_map_arena(EnMT ? 8 * fm_stride : nset), used_map(nset), alloc_map(nset, -1) {
 #ifdef CHECK_MULTI
   #ifdef BOOST_STACKTRACE_LINK
     alloc_record.resize(nset, {0, ""});
@@ -126,18 +243,11 @@ public:
   #endif
 #endif
     constexpr uint64_t fmap = NW < 64 ? (1ull << NW) - 1 : ~(0ull);
-    if constexpr (EnMT) {
-      for (auto &s: free_map_mt) s = new std::atomic<uint64_t>(fmap);
-    } else
-      for (auto &s: free_map_st) s = fmap;
-  }
-
-  virtual ~ReplaceFuncBase() {
-    if constexpr (EnMT) for (auto s: free_map_mt) delete s;
+    for(uint32_t s=0; s<nset; s++) free_map(s) = fmap;
   }
 
   __always_inline uint32_t get_free_num(uint32_t s) { // return the number of free places by popcount the free map
-    auto fmap = EnMT ? free_map_mt[s]->load() : free_map_st[s];
+    uint64_t fmap = free_map(s);
 #ifdef __cpp_lib_bitops
     return std::popcount(fmap);
 #elif defined __GNUG__
@@ -152,7 +262,7 @@ public:
 #endif
   }
 
-  virtual void replace(uint32_t s, uint32_t *w, bool empty_fill_rt = true) {
+  virtual void replace(uint32_t s, uint32_t *w, bool empty_fill_rt = true) override {
     int32_t i = 0;
     if (EF && empty_fill_rt) {
       i = alloc_from_free(s);
@@ -166,14 +276,12 @@ public:
     *w = i;
   }
 
-  virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) = 0;
-
-  virtual void invalid(uint32_t s, uint32_t w, bool flush = false) {
+  virtual void invalid(uint32_t s, uint32_t w, bool flush = false) override {
     if((int32_t)w != alloc_map[s]) list_to_free(s, w);
   }
 
-  virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const {
-    return used_map[s][w];
+  virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const override {
+    return used_map.get(s, w);
   }
 };
 
@@ -190,30 +298,27 @@ protected:
   using RPT::used_map;
 
   virtual uint32_t select(uint32_t s) override {
-    for(uint32_t i=0; i<NW; i++)
-      if(used_map[s][i] == 0) return i;
-    assert(0 == "replacer used_map corrupted!");
-    return -1;
+    auto i = used_map.find(s, 0);
+    if constexpr (EnMT) for(uint32_t v=1; i<0 && v<NW; v++) i = used_map.find(s, v); // rank 0 transiently missing in a concurrent update
+    assert(i >= 0 || 0 == "replacer used_map corrupted!");
+    return i;
   }
 
 public:
-  ReplaceFIFO() : RPT(1ul << IW) {
-    for (auto &s: used_map) {
-      s.resize(NW);
-      for(uint32_t i=0; i<NW; i++) s[i] = i;
-    }
+  ReplaceFIFO(uint32_t nset = 1ul << IW) : RPT(nset) {
+    for(uint32_t i=0; i<NW; i++) used_map.set_init(i, i);
   }
 
   virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
     if((int32_t)w == alloc_map[s] && demand_acc) {
       this->set_alloc_map(s, -1);
-      auto prio = used_map[s][w];
+      auto prio = used_map.get(s, w);
       if(!prefetch) {
-        for(uint32_t i=0; i<NW; i++) if(used_map[s][i] > prio) used_map[s][i]--;
-        used_map[s][w] = NW-1;
+        used_map.dec_above(s, prio);
+        used_map.set(s, w, NW-1);
       } else if(prio > 0) { // prefetch and insert into empty
-        for(uint32_t i=0; i<NW; i++) if(used_map[s][i] < prio) used_map[s][i]++;
-        used_map[s][w] = 0; // insert at LRU position
+        used_map.inc_below(s, prio);
+        used_map.set(s, w, 0); // insert at LRU position
       }
     }
     if constexpr (EnMT) RPT::delist_from_free(s, w);
@@ -233,15 +338,17 @@ protected:
   using RPT::used_map;
 
 public:
+  using ReplaceFIFO<IW, NW, EF, DUO, EnMT>::ReplaceFIFO;
+
   virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
     if((int32_t)w == alloc_map[s] || !DUO || demand_acc) {
-      auto prio = used_map[s][w];
+      auto prio = used_map.get(s, w);
       if(!prefetch) {
-        for(uint32_t i=0; i<NW; i++) if(used_map[s][i] > prio) used_map[s][i]--;
-        used_map[s][w] = NW-1;
+        used_map.dec_above(s, prio);
+        used_map.set(s, w, NW-1);
       } else if(prio > 0){ // prefetch and insert into empty
-        for(uint32_t i=0; i<NW; i++) if(used_map[s][i] < prio) used_map[s][i]++;
-        used_map[s][w] = 0; // insert at LRU position
+        used_map.inc_below(s, prio);
+        used_map.set(s, w, 0); // insert at LRU position
       }
     }
     if((int32_t)w == alloc_map[s] && demand_acc) this->set_alloc_map(s, -1);
@@ -250,52 +357,241 @@ public:
 };
 
 /////////////////////////////////
-// Static RRIP replacement
+// Tree pseudo-LRU replacement
 // IW: index width, NW: number of ways
 // EF: empty first, DUO: demand update only (do not update state for release)
+// The NW-1 nodes of a binary tree over the ways are kept as bits of one word per set, node n (root 1) having
+// children 2n and 2n+1 and its bit pointing to the child holding the next victim (1: right).
+// An access flips the log2(NW) nodes on the path of a way, a non-power-of-two NW uses a tree of the next power of two
+// with the subtrees holding no way skipped.
 template<int IW, int NW, bool EF, bool DUO, bool EnMT>
-class ReplaceSRRIP : public ReplaceFuncBase<EF, NW, EnMT>
+class ReplacePLRU : public ReplaceFuncBase<EF, NW, EnMT>
 {
   typedef ReplaceFuncBase<EF, NW, EnMT> RPT;
+  static constexpr int D = NW > 1 ? 64 - __builtin_clzll(NW - 1) : 0; // depth of the tree
+  static constexpr uint32_t leaf = 1u << D; // node of way 0
+
+  // nodes on the path of each way (mask) and their values pointing away from the way (away)
+  static constexpr std::array<std::pair<uint64_t, uint64_t>, NW> path = [] {
+    std::array<std::pair<uint64_t, uint64_t>, NW> rv{};
+    for(uint32_t w=0; w<NW; w++)
+      for(uint32_t n = leaf + w; n > 1; n >>= 1) {
+        rv[w].first  |= 1ull << (n >> 1);
+        rv[w].second |= (uint64_t)(1 - (n & 1)) << (n >> 1);
+      }
+    return rv;
+  }();
+
+  // number of ways in the subtree of node n at height h
+  static __always_inline uint32_t ways(uint32_t n, int h) {
+    int32_t first = (n << h) - leaf;
+    return first >= NW ? 0 : NW - first < (1 << h) ? NW - first : 1 << h;
+  }
+
 protected:
-  using RPT::used_map;
   using RPT::alloc_map;
+  CMLazyRows<uint64_t, 1, EnMT> tree; // tree of each set, allocated when a set is touched
 
   virtual uint32_t select(uint32_t s) override {
-    uint32_t max_prio = used_map[s][0];
-    uint32_t max_i    = 0;
-    for(uint32_t i=1; i<NW; i++) if(used_map[s][i] > max_prio) {max_prio = used_map[s][i]; max_i = i;}
-    uint32_t gap = 3 - max_prio;
-    if(gap > 0) for(uint32_t i=0; i<NW; i++) used_map[s][i] += gap;
-    return max_i;
+    auto t = cm_load_word<EnMT>(*tree[s]);
+    uint32_t n = 1;
+    for(int h = D-1; h >= 0; h--) {
+      n = 2*n + ((t >> n) & 1);
+      if((n << h) - leaf >= NW) n ^= 1; // no way in the right subtree
+    }
+    return n - leaf;
   }
 
 public:
-  ReplaceSRRIP() : RPT(1ul << IW) {
-    for (auto &s: used_map) s.resize(NW, 3);
+  ReplacePLRU(uint32_t nset = 1ul << IW) : RPT(nset), tree(nset) {}
+
+  virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
+    if((int32_t)w == alloc_map[s] || !DUO || demand_acc) {
+      uint64_t mask = path[w].first, away = path[w].second;
+      if(!prefetch) cm_update_word<EnMT>(*tree[s], [=](uint64_t t) { return (t & ~mask) | away; });
+      else          cm_update_word<EnMT>(*tree[s], [=](uint64_t t) { return (t & ~mask) | (~away & mask); }); // point to the way, the next victim
+    }
+    if((int32_t)w == alloc_map[s] && demand_acc) this->set_alloc_map(s, -1);
+    if constexpr (EnMT) RPT::delist_from_free(s, w);
   }
 
+  // the ways in the subtrees pointed to on the path of w are evicted before w
+  virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const override {
+    auto t = cm_load_word<EnMT>(*tree[s]);
+    uint32_t rank = 0;
+    int h = 0;
+    for(uint32_t n = leaf + w; n > 1; n >>= 1, h++)
+      if(((t >> (n >> 1)) & 1) != (n & 1)) rank += ways(n ^ 1, h);
+    return rank;
+  }
+};
+
+/////////////////////////////////
+// Bit pseudo-LRU (MRU bit) replacement
+// IW: index width, NW: number of ways
+// EF: empty first, DUO: demand update only (do not update state for release)
+// A set keeps an MRU bit per way in one word, the victim is the first way with a cleared bit
+// and all other bits are cleared when an access sets the last one.
+template<int IW, int NW, bool EF, bool DUO, bool EnMT>
+class ReplaceBitPLRU : public ReplaceFuncBase<EF, NW, EnMT>
+{
+  typedef ReplaceFuncBase<EF, NW, EnMT> RPT;
+  static constexpr uint64_t all = NW < 64 ? (1ull << NW) - 1 : ~0ull;
+
+protected:
+  using RPT::alloc_map;
+  CMLazyRows<uint64_t, 1, EnMT> mru; // MRU bits of each set, allocated when a set is touched
+
+  virtual uint32_t select(uint32_t s) override {
+    return __builtin_ctzll(~cm_load_word<EnMT>(*mru[s]) & all);
+  }
+
+public:
+  ReplaceBitPLRU(uint32_t nset = 1ul << IW) : RPT(nset), mru(nset) {}
+
   virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
+    if((int32_t)w == alloc_map[s] || !DUO || demand_acc) {
+      uint64_t b = 1ull << w;
+      if(!prefetch) cm_update_word<EnMT>(*mru[s], [=](uint64_t m) { return (m | b) == all ? b : m | b; });
+      else          cm_update_word<EnMT>(*mru[s], [=](uint64_t m) { return m & ~b; }); // leave the way as a candidate victim
+    }
+    if((int32_t)w == alloc_map[s] && demand_acc) this->set_alloc_map(s, -1);
+    if constexpr (EnMT) RPT::delist_from_free(s, w);
+  }
+
+  // the ways with cleared bits go first, each group in the order of way
+  virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const override {
+    auto m = cm_load_word<EnMT>(*mru[s]);
+    uint64_t before = (1ull << w) - 1;
+    if(m & (1ull << w)) return __builtin_popcountll(~m & all) + __builtin_popcountll(m & before);
+    else                return __builtin_popcountll(~m & before);
+  }
+};
+
+/////////////////////////////////
+// Static RRIP replacement
+// IW: index width, NW: number of ways
+// EF: empty first, DUO: demand update only (do not update state for release)
+template<int IW, int NW, bool EF, bool DUO, bool EnMT>
+class ReplaceSRRIP : public ReplaceFuncBase<EF, NW, EnMT>
+{
+  typedef ReplaceFuncBase<EF, NW, EnMT> RPT;
+protected:
+  using RPT::used_map;
+  using RPT::alloc_map;
+
+  virtual uint32_t select(uint32_t s) override {
+    int32_t i;
+    while((i = used_map.find(s, 3)) < 0) // age all ways until one reaches 3 (retried if a concurrent access resets it)
+      used_map.add(s, used_map.any_ge(s, 2) ? 1 : used_map.any_ge(s, 1) ? 2 : 3, 3);
+    return i;
+  }
+
+  // update the RRPV of an accessed way, a newly inserted way takes the RRPV returned by insert()
+  template<typename F>
+  __always_inline void access_rrpv(uint32_t s, uint32_t w, bool demand_acc, bool prefetch, F insert) {
     if((int32_t)w == alloc_map[s] || !DUO || demand_acc) {
       if(!prefetch)
-        used_map[s][w] = ((int32_t)w == alloc_map[s]) ? 2 : 0;
+        used_map.set(s, w, ((int32_t)w == alloc_map[s]) ? insert() : 0);
       else // prefetch
-        used_map[s][w] = 3;
+        used_map.set(s, w, 3);
     }
     if((int32_t)w == alloc_map[s] && demand_acc) this->set_alloc_map(s, -1);
-    if constexpr (EnMT) RPT::delist_from_free(s, w, demand_acc);
+    if constexpr (EnMT) RPT::delist_from_free(s, w);
+  }
+
+public:
+  ReplaceSRRIP(uint32_t nset = 1ul << IW) : RPT(nset) {
+    for(uint32_t i=0; i<NW; i++) used_map.set_init(i, 3);
+  }
+
+  virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
+    access_rrpv(s, w, demand_acc, prefetch, [] { return 2; });
   }
 
   virtual void invalid(uint32_t s, uint32_t w, bool flush) override {
-    used_map[s][w] = 3;
+    used_map.set(s, w, 3);
     RPT::invalid(s, w, false);
   }
 
   virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const {
-    uint32_t prio = used_map[s][w];
-    uint32_t rank = 0;
-    for(uint32_t i=1; i<NW; i++) if(used_map[s][i] > prio || (used_map[s][i] == prio && i < w)) rank++;
-    return rank;
+    return used_map.rank(s, w);
+  }
+};
+
+/////////////////////////////////
+// Bimodal RRIP replacement
+// IW: index width, NW: number of ways
+// EF: empty first, DUO: demand update only (do not update state for release)
+// A block is inserted with a distant RRPV (3) and only 1 in 32 with a long RRPV (2), protecting the cache from thrashing.
+template<int IW, int NW, bool EF, bool DUO, bool EnMT>
+class ReplaceBRRIP : public ReplaceSRRIP<IW, NW, EF, DUO, EnMT>
+{
+  typedef ReplaceSRRIP<IW, NW, EF, DUO, EnMT> RPT;
+public:
+  using RPT::RPT;
+
+  virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
+    this->access_rrpv(s, w, demand_acc, prefetch, [] { return cm_random()(32) ? 3 : 2; });
+  }
+};
+
+/////////////////////////////////
+// Dynamic RRIP replacement
+// IW: index width, NW: number of ways
+// EF: empty first, DUO: demand update only (do not update state for release)
+// Set dueling between SRRIP and BRRIP: a few leader sets always use one of them and count their misses
+// in a saturating policy selector (PSEL), the other (follower) sets use the one with fewer misses.
+// The sets are divided into 32 constituencies of nset/32 sets, and each constituency has one SRRIP leader
+// (the set at the offset of the constituency number) and one BRRIP leader (half a constituency away).
+// A constituency has at least 8 sets, so a cache with fewer than 256 sets has fewer constituencies
+// (a cache of 4 to 15 sets is one constituency) and at most a quarter of its sets lead,
+// with fewer than 4 sets there is no room to duel: all sets follow the untrained PSEL, i.e. DRRIP falls back to SRRIP.
+template<int IW, int NW, bool EF, bool DUO, bool EnMT>
+class ReplaceDRRIP : public ReplaceSRRIP<IW, NW, EF, DUO, EnMT>
+{
+  typedef ReplaceSRRIP<IW, NW, EF, DUO, EnMT> RPT;
+  static constexpr int32_t psel_max = 1023; // 10-bit PSEL
+  static constexpr uint32_t cnum = 32;      // number of constituencies
+  static constexpr uint32_t cmin = 8;       // minimal number of sets in a constituency
+  std::vector<uint8_t> lead;                // 1: SRRIP leader, 2: BRRIP leader, 0: follower
+  std::conditional_t<EnMT, std::atomic<int32_t>, int32_t> psel;
+
+  __always_inline int leader(uint32_t s) const { return lead[s]; }
+
+  static std::vector<uint8_t> leader_sets(uint32_t nset) {
+    std::vector<uint8_t> lead(nset, 0);
+    if(nset < 4) return lead;
+    uint32_t nc = std::clamp(nset / cmin, 1u, cnum), cs = nset / nc; // number and size of constituencies
+    for(uint32_t c = 0; c < nc; c++) {
+      lead[c*cs + c % cs] = 1;
+      lead[c*cs + (c + cs/2) % cs] = 2;
+    }
+    return lead;
+  }
+
+public:
+  ReplaceDRRIP(uint32_t nset = 1ul << IW) : RPT(nset), lead(leader_sets(nset)), psel(psel_max/2) {}
+
+  virtual void replace(uint32_t s, uint32_t *w, bool empty_fill_rt = true) override {
+    if(auto l = leader(s)) { // a miss in a leader set
+      if constexpr (EnMT) {
+        int32_t v = psel.load(std::memory_order_relaxed);
+        while((l == 1 ? v < psel_max : v > 0) && !psel.compare_exchange_weak(v, l == 1 ? v + 1 : v - 1, std::memory_order_relaxed));
+      } else {
+        if(l == 1 && psel < psel_max) psel++;
+        if(l == 2 && psel > 0)        psel--;
+      }
+    }
+    RPT::replace(s, w, empty_fill_rt);
+  }
+
+  virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
+    this->access_rrpv(s, w, demand_acc, prefetch, [&] {
+      auto l = leader(s);
+      bool bimodal = l == 2 || (l == 0 && psel > psel_max/2); // SRRIP misses more
+      return bimodal && cm_random()(32) ? 3 : 2;
+    });
   }
 };
 
@@ -309,20 +605,18 @@ class ReplaceRandom : public ReplaceFuncBase<EF, NW, EnMT>
   typedef ReplaceFuncBase<EF, NW, EnMT> RPT;
 protected:
   using RPT::alloc_map;
-
-  RandomGen<uint32_t> * loc_random; // a local randomizer for better thread parallelism
+  CMRandomLocal<EnMT> loc_random; // a local randomizer
 
   virtual uint32_t select(uint32_t s) override {
-    return (*loc_random)() % NW;
+    return loc_random(NW);
   }
 
 public:
-  ReplaceRandom() : RPT(1ul << IW), loc_random(cm_alloc_rand32()) {}
-  virtual ~ReplaceRandom() override { delete loc_random; }
+  ReplaceRandom(uint32_t nset = 1ul << IW) : RPT(nset) {}
 
   virtual void access(uint32_t s, uint32_t w, bool demand_acc, bool prefetch) override {
     if((int32_t)w == alloc_map[s] && demand_acc) this->set_alloc_map(s, -1);
-    if constexpr (EnMT) RPT::delist_from_free(s, w, demand_acc);
+    if constexpr (EnMT) RPT::delist_from_free(s, w);
   }
 
   virtual uint32_t eviction_rank(uint32_t s, uint32_t w) const {
@@ -330,4 +624,28 @@ public:
   }
 };
 
+/////////////////////////////////
+// Replacer with the number of ways decided at run time
+// RPT: replacer type, EF: empty first, DUO: demand update only (do not update state for release)
+// A replacer specialised for the way number is chosen from the supported way numbers (RTWays).
+template<template <int, int, bool, bool, bool> class RPT, bool EF, bool DUO, bool EnMT>
+struct ReplaceRT
+{
+  typedef std::integer_sequence<int, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 16, 20, 24, 32, 48, 64> RTWays;
+
+  static ReplaceBase *gen(uint32_t nset, uint32_t nway) {
+    auto rv = gen(nset, nway, RTWays());
+    if(!rv) throw std::invalid_argument("ReplaceRT: unsupported number of ways " + std::to_string(nway));
+    return rv;
+  }
+
+private:
+  template<int... NW>
+  static ReplaceBase *gen(uint32_t nset, uint32_t nway, std::integer_sequence<int, NW...>) {
+    ReplaceBase *rv = nullptr;
+    ((nway == NW && (rv = new RPT<0, NW, EF, DUO, EnMT>(nset))) || ...);
+    return rv;
+  }
+};
+
 #endif
@@ -0,0 +1,209 @@
+#ifndef CM_CACHE_RUNTIME_GEOMETRY_HPP
+#define CM_CACHE_RUNTIME_GEOMETRY_HPP
+
+// caches with their geometry (set number, way number, partition number and MSHR number) decided at run time,
+// so a design-space sweep needs no recompilation for each point
+
+#include "cache/cache.hpp"
+
+// geometry of a cache
+struct CacheGeometry
+{
+  int iw;        // index width
+  int nw;        // number of ways
+  int p = 1;     // number of partitions
+  int mshr = 4;  // maximal number of transactions on the fly
+  uint32_t nset = 0; // number of sets when it is not a power of two (iw is then ignored), see IndexModuloRT
+
+  uint32_t sets() const { return nset ? nset : 1ul << iw; }
+};
+
+// normal set associative cache array with the number of sets and ways decided at run time
+// MT: metadata type, DT: data type (void if not in use)
+// EnMT: enable multithread support
+template<typename MT, typename DT, bool EnMT>
+  requires C_DERIVE<MT, CMMetadataCommon> && C_DERIVE_OR_VOID<DT, CMDataBase>
+class CacheArrayNormRT : public CacheArrayMTBase<EnMT>
+{
+  typedef typename std::conditional<EnMT, MetaLock<MT>, MT>::type C_MT;
+protected:
+  const uint32_t nset;
+  const unsigned int nway;     // number of ways (data blocks) of a set
+  const unsigned int way_num;  // number of ways including extra ways
+  CMArena<C_MT> meta;          // meta array
+  CMArena<DT> data;            // data array, could be empty
+
+  // search a set of N ways, the loop is fully unrolled for a way number known at compile time
+  template<unsigned int N>
+  __always_inline bool hit_set(uint64_t addr, uint32_t s, uint32_t *w) const {
+    auto set_meta = meta[s*N];
+    for(unsigned int i=0; i<N; i++)
+      if(set_meta[i].match(addr)) {
+        *w = i;
+        return true;
+      }
+    return false;
+  }
+
+public:
+  CacheArrayNormRT(uint32_t nset, unsigned int nway, unsigned int extra_way = 0)
+    : CacheArrayMTBase<EnMT>(nset), nset(nset), nway(nway), way_num(nway+extra_way),
+      meta(nset * way_num), data(C_VOID<DT> ? 0 : nset * nway)
+  {
+    if(extra_way)
+      for(unsigned int s=0; s<nset; s++)
+        for(unsigned int w=nway; w<way_num; w++)
+          meta[s*way_num+w]->to_extend();
+  }
+
+  virtual bool hit(uint64_t addr, uint32_t s, uint32_t *w) const override {
+    switch(way_num) { // specialised for the common way numbers
+    case 2:  return hit_set<2>(addr, s, w);
+    case 4:  return hit_set<4>(addr, s, w);
+    case 8:  return hit_set<8>(addr, s, w);
+    case 16: return hit_set<16>(addr, s, w);
+    default:
+      for(unsigned int i=0; i<way_num; i++)
+        if(meta[s*way_num + i]->match(addr)) {
+          *w = i;
+          return true;
+        }
+      return false;
+    }
+  }
+
+  virtual CMMetadataCommon * get_meta(uint32_t s, uint32_t w) override { return meta[s*way_num + w]; }
+  virtual CMDataBase * get_data(uint32_t s, uint32_t w) override {
+    if constexpr (C_VOID<DT>) return nullptr;
+    else                      return data[s*nway + w];
+  }
+};
+
+// Skewed cache with its geometry decided at run time
+// MT: metadata type (its index width must be 0 as the number of sets is unknown at compile time)
+// DT: data type (void if not in use)
+// IDX: run-time indexer type (IndexNormRT, IndexSkewedRT, IndexModuloRT, IndexSkewedModuloRT), RPC: run-time replacer type (ReplaceRT)
+// EnMon: whether to enable monitoring
+// EnMT: enable multithread
+template<typename MT, typename DT, typename IDX, typename RPC, typename DLY, bool EnMon, bool EnMT = false>
+  requires C_DERIVE<MT, CMMetadataBase> && C_DERIVE_OR_VOID<DT, CMDataBase> &&
+           C_DERIVE<IDX, IndexFuncBase> && C_DERIVE_OR_VOID<DLY, DelayBase>
+class CacheSkewedRT : public CacheBuffered<MT, DT, EnMT>
+{
+protected:
+  typedef CacheArrayNormRT<MT, DT, EnMT> CacheArrayT;
+  typedef CacheMonitorImp<DLY, EnMon> CacheMonitorT;
+  using CacheBase::arrays;
+
+  const CacheGeometry geo;
+  IDX indexer;                        // index resolver
+  std::vector<ReplaceBase *> replacer; // replacer
+  CMRandomLocal<EnMT> loc_random;     // a local randomizer
+
+  // all arrays are CacheArrayT and the monitor container is always CacheMonitorT,
+  // so they are accessed without virtual dispatch
+  __always_inline CacheArrayT *array(uint32_t ai) const { return static_cast<CacheArrayT *>(arrays[ai]); }
+  __always_inline CacheMonitorT *monitor() const { return static_cast<CacheMonitorT *>(this->monitors); }
+
+  virtual void replace_choose_set(uint64_t addr, uint32_t *ai, uint32_t *s, unsigned int) {
+    if(geo.p == 1) *ai = 0;
+    else           *ai = loc_random(geo.p);
+    *s = indexer.index(addr, *ai);
+  }
+
+public:
+  CacheSkewedRT(std::string name, const CacheGeometry &geo)
+    : CacheBuffered<MT, DT, EnMT>(name, geo.mshr), geo(geo), indexer(geo.sets(), geo.p), replacer(geo.p)
+  {
+    arrays.resize(geo.p);
+    for(int i=0; i<geo.p; i++) {
+      arrays[i] = new CacheArrayT(geo.sets(), geo.nw);
+      replacer[i] = RPC::gen(geo.sets(), geo.nw);
+    }
+    CacheMonitorSupport::monitors = new CacheMonitorT(CacheBase::id);
+  }
+
+  virtual ~CacheSkewedRT() override {
+    delete CacheMonitorSupport::monitors;
+    for(auto r : replacer) delete r;
+  }
+
+  virtual std::tuple<int, int, int> size() const override { return std::make_tuple(geo.p, geo.sets(), geo.nw); }
+
+  using CacheBase::hit;
+  virtual bool hit(uint64_t addr, uint32_t *ai, uint32_t *s, uint32_t *w, uint16_t prio, bool check_and_set) override {
+    for(*ai=0; *ai<(uint32_t)geo.p; (*ai)++) {
+      *s = indexer.index(addr, *ai);
+      if(EnMT && check_and_set) this->set_mt_state(*ai, *s, prio);
+      if(array(*ai)->CacheArrayT::hit(addr, *s, w)) return true;
+      if(EnMT && check_and_set) this->reset_mt_state(*ai, *s, prio);
+    }
+    return false;
+  }
+
+  virtual std::pair<CMMetadataBase *, CMDataBase *> access_line(uint32_t ai, uint32_t s, uint32_t w) override {
+    auto meta = static_cast<CMMetadataBase *>(array(ai)->CacheArrayT::get_meta(s, w));
+    if constexpr (!C_VOID<DT>)
+      return std::make_pair(meta, array(ai)->CacheArrayT::get_data(s, w));
+    else
+      return std::make_pair(meta, nullptr);
+  }
+
+  virtual bool replace(uint64_t addr, uint32_t *ai, uint32_t *s, uint32_t *w, uint16_t prio, unsigned int genre = 0) override {
+    replace_choose_set(addr, ai, s, genre);
+    if(EnMT) {
+      this->set_mt_state(*ai, *s, prio);
+      // double check the miss status
+      if(CacheBase::hit(addr)) { // the exact cache block is re-inserted by other transactions
+        this->reset_mt_state(*ai, *s, prio);
+        return false;
+      }
+    }
+    replacer[*ai]->replace(*s, w);
+    return true;
+  }
+
+  // eviction rank of a way, computed only when an attached monitor reads it
+  __always_inline int32_t ev_rank(uint32_t ai, uint32_t s, uint32_t w) const {
+    return (ai < replacer.size() && monitor()->need_ev_rank()) ? replacer[ai]->eviction_rank(s, w) : -1;
+  }
+
+  virtual void hook_read(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_read(addr, ai, s, w, ev_rank(ai, s, w), hit, meta, data, delay);
+  }
+
+  virtual void replace_read(uint32_t ai, uint32_t s, uint32_t w, bool prefetch, bool genre = false) override {
+    if(ai < replacer.size()) replacer[ai]->access(s, w, true, prefetch);
+  }
+
+  virtual void hook_write(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_write(addr, ai, s, w, ev_rank(ai, s, w), hit, meta, data, delay);
+  }
+
+  virtual void replace_write(uint32_t ai, uint32_t s, uint32_t w, bool demand_acc, bool genre = false) override {
+    if(ai < replacer.size()) replacer[ai]->access(s, w, demand_acc, false);
+  }
+
+  virtual void hook_manage(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool writeback, const CMMetadataBase * meta, const CMDataBase *data, uint64_t *delay) override {
+    if constexpr (EnMon || !C_VOID<DLY>) monitor()->hook_manage(addr, ai, s, w, ev_rank(ai, s, w), hit, evict, writeback, meta, data, delay);
+  }
+
+  virtual void replace_manage(uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool genre = false) override {
+    if(ai < replacer.size() && hit && evict) replacer[ai]->invalid(s, w, evict == 2);
+  }
+
+  virtual bool query_coloc(uint64_t addrA, uint64_t addrB) override {
+    for(int i=0; i<geo.p; i++)
+      if(indexer.index(addrA, i) == indexer.index(addrB, i))
+        return true;
+    return false;
+  }
+
+  virtual void query_fill_loc(LocInfo *loc, uint64_t addr) override {
+    for(int i=0; i<geo.p; i++){
+      loc->insert(LocIdx(i, indexer.index(addr, i)), LocRange(0, geo.nw-1));
+    }
+  }
+};
+
+#endif
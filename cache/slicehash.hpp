@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <cstdint>
 #include <cassert>
+#include <vector>
 #include "util/random.hpp"
 
 /////////////////////////////////
@@ -16,6 +17,11 @@ protected:
 public:
   SliceHashBase(int s) : slice(s) {}
   virtual uint32_t operator () (uint64_t addr) = 0;
+
+  // slices of n addresses
+  virtual void operator () (const uint64_t *addr, uint32_t *rv, unsigned int n) {
+    for(unsigned int i=0; i<n; i++) rv[i] = (*this)(addr[i]);
+  }
 };
 
 /////////////////////////////////
@@ -25,11 +31,12 @@ class SliceHashNorm : public SliceHashBase
 {
 public:
   SliceHashNorm(int s): SliceHashBase(s) {}
+  using SliceHashBase::operator();
   virtual uint32_t operator () (uint64_t addr) override { return (addr >> BlkOfst) % slice; }
 };
 
 /////////////////////////////////
-// Inel complex address scheme (CAS)
+// Inel complex address scheme (CAS), see SliceHashTable for other numbers of slices
 class SliceHashIntelCAS : public SliceHashBase
 {
   AddrXORHash hash;
@@ -41,8 +48,75 @@ public:
     else             assert(0 == "The number of slices must be equal to 2, 4 or 8!");
   }
 
+  using SliceHashBase::operator();
   uint32_t virtual operator () (uint64_t addr) override { return hash(addr); }
+  virtual void operator () (const uint64_t *addr, uint32_t *rv, unsigned int n) override { hash(addr, rv, n); }
+
+};
 
+/////////////////////////////////
+// table-driven complex address scheme for any number of slices
+//   slice = seq[h(addr)], h is a k-bit XOR hash (one mask per bit) and seq holds 2^k slice numbers,
+//   which is the linear hash plus base sequence structure reverse engineered on Intel LLCs with
+//   a non-power-of-two number of slices (e.g. 6, 10, 12, 18, 24 and 28)
+// h is linear, so it is the XOR of the precomputed hashes of each address byte (one lookup per byte for any k).
+// The masks and the sequence of a specific processor can be given to the constructor.
+// Otherwise 2, 4 and 8 slices use the published linear functions (same as SliceHashIntelCAS),
+// and the other numbers use fixed pseudo-random masks over bit 6 to 39 with an evenly distributed sequence,
+// as no complete function of them is publicly available.
+class SliceHashTable : public SliceHashBase
+{
+  std::vector<uint16_t> seq;
+  std::vector<uint16_t> tbl; // tbl[b*256 + v]: hash of an address with byte b equal to v and other bytes 0
+  unsigned int nbyte = 0;    // number of address bytes covered by the masks
+
+  void init(const std::vector<uint64_t>& masks) {
+    assert(seq.size() == (1ull << masks.size()) || 0 == "The sequence must have 2^(number of masks) entries!");
+    for(auto m : masks) while(nbyte < 8 && (m >> (8*nbyte))) nbyte++;
+    tbl.resize(nbyte * 256);
+    for(unsigned int b=0; b<nbyte; b++)
+      for(uint64_t v=0; v<256; v++) {
+        uint16_t h = 0;
+        for(auto m : masks) h = (h << 1) | __builtin_parityll(m & (v << (8*b)));
+        tbl[b*256 + v] = h;
+      }
+  }
+
+public:
+  SliceHashTable(int s, const std::vector<uint64_t>& masks, const std::vector<uint16_t>& seq)
+    : SliceHashBase(s), seq(seq)
+  {
+    init(masks);
+  }
+
+  SliceHashTable(int s) : SliceHashBase(s) {
+    std::vector<uint64_t> masks;
+    if (s == 2)      masks = {0x15f575440ull};
+    else if (s == 4) masks = {0x6b5faa880ull, 0x35f575440ull};
+    else if (s == 8) masks = {0x3cccc93100ull, 0x2eb5faa880ull, 0x1b5f575400ull};
+    else if (s > 1) {
+      unsigned int k = 6; // 2^6 entries per slice, the slices differ in size by at most 1/64
+      while((1 << (k-6)) < s) k++;
+      uint64_t v = 0x5eed5eed5eed5eedull;
+      while(masks.size() < k) {
+        v += 0x9e3779b97f4a7c15ull; // splitmix64
+        uint64_t m = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+        m = (m ^ (m >> 27)) * 0x94d049bb133111ebull;
+        m = (m ^ (m >> 31)) & 0xffffffffc0ull;
+        if(m) masks.push_back(m);
+      }
+    }
+    seq.resize(1ull << masks.size());
+    for(unsigned int i=0; i<seq.size(); i++) seq[i] = i % s;
+    init(masks);
+  }
+
+  using SliceHashBase::operator();
+  virtual uint32_t operator () (uint64_t addr) override {
+    uint32_t h = 0;
+    for(unsigned int b=0; b<nbyte; b++, addr >>= 8) h ^= tbl[b*256 + (addr & 0xff)];
+    return seq[h];
+  }
 };
 
 #endif
@@ -0,0 +1,61 @@
+#include "cache/memory.hpp"
+#include "util/cache_type.hpp"
+#include <cstdio>
+#include <unordered_map>
+
+// dead block prediction with bypass: the L1s bypass blocks predicted dead and the L2 inserts them at the distant
+// priority, a hot region is shared by both cores and every core streams through a region never reused
+
+#define NCore 2
+#define Round 64
+#define HotN 8
+#define StreamN 64
+
+typedef Data64B data_type;
+typedef MetadataBroadcastBase meta_type;
+typedef MSIPolicy<true, false, policy_memory> policy_l1;
+typedef MSIPolicy<false, true, policy_memory> policy_l2;
+
+int main() {
+  auto l1d = cache_gen_l1<2, 4, data_type, meta_type, ReplaceSRRIP, MSIPolicy, policy_l1, false, void, false, false,
+                          CacheArrayNorm, false, false, true, true>(NCore, "l1d");
+  auto core_data = get_l1_core_interface(l1d);
+  auto l2 = cache_gen_inc<4, 8, data_type, meta_type, ReplaceSRRIP, MSIPolicy, policy_l2, true, void, false, false,
+                          CacheArrayNorm, false, false, true, false>(1, "l2");
+  auto mem = new SimpleMemoryModel<data_type, void, false>("mem");
+  for(auto l1 : l1d) l1->outer->connect(l2[0]->inner);
+  l2[0]->outer->connect(mem);
+
+  std::unordered_map<uint64_t, uint64_t> ref;
+  data_type d;
+  int err = 0;
+  for(int r=0; r<Round; r++) {
+    for(int c=0; c<NCore; c++) {
+      auto core = core_data[c];
+      for(uint64_t i=0; i<HotN; i++) { // the hot region, written by both cores in turn
+        uint64_t addr = 0x100000 + i*64;
+        if(core->read(addr, nullptr)->read(0) != ref[addr]) err++;
+        if((r + i) % NCore == (uint64_t)c) {
+          ref[addr] = (addr << 8) | (r*NCore + c);
+          d.write(0, ref[addr], 0xffffffffffffffffull);
+          core->write(addr, &d, nullptr);
+        }
+      }
+      for(uint64_t i=0; i<StreamN; i++) { // the streaming region of a core, read once
+        uint64_t addr = 0x40000000 + (((uint64_t)c*Round + r)*StreamN + i)*64;
+        if(core->read(addr, nullptr)->read(0) != 0) err++;
+      }
+    }
+  }
+
+  for(int c=0; c<NCore; c++) { // flush all and check the memory
+    for(uint64_t i=0; i<HotN; i++) core_data[c]->flush(0x100000 + i*64, nullptr);
+  }
+  for(uint64_t i=0; i<HotN; i++) {
+    uint64_t addr = 0x100000 + i*64;
+    if(core_data[0]->read(addr, nullptr)->read(0) != ref[addr]) err++;
+  }
+
+  printf("c2-l2-bypass: %d errors\n", err);
+  return err;
+}
@@ -0,0 +1,42 @@
+#include "cache/memory.hpp"
+#include "util/cache_type.hpp"
+#include "util/regression.hpp"
+#include <cstdio>
+
+// the c2-l2 hierarchy on the structure-of-arrays tag store (CacheArraySoA), whose tag match uses the SIMD kernels
+// when the target ISA provides them (see SIMD in the Makefile), a directory L2 with 16 ways covers the wider vectors
+
+#define PAddrN 128
+#define SAddrN 64
+#define NCore 2
+#define TestN ((PAddrN + SAddrN) * NCore * 2 * 200)
+
+typedef Data64B data_type;
+typedef MetadataBroadcastBase meta_type;
+typedef MetadataDirectoryBase meta_dir_type;
+typedef MSIPolicy<true, false, policy_memory> policy_l1;
+typedef MSIPolicy<false, true, policy_memory> policy_l2;
+
+int main() {
+  auto l1d = cache_gen_l1<4, 4, data_type, meta_type, ReplaceLRU, MSIPolicy, policy_l1, false, void, false, false, CacheArraySoA>(NCore, "l1d");
+  auto core_data = get_l1_core_interface(l1d);
+  auto l1i = cache_gen_l1<4, 4, data_type, meta_type, ReplaceLRU, MSIPolicy, policy_l1, false, void, false, false, CacheArraySoA>(NCore, "l1i");
+  auto core_inst = get_l1_core_interface(l1i);
+  auto l2 = cache_gen_inc<4, 16, data_type, meta_dir_type, ReplaceLRU, MSIPolicy, policy_l2, true, void, false, false, CacheArraySoA>(1, "l2");
+  auto mem = new SimpleMemoryModel<data_type, void, false>("mem");
+  for(int i=0; i<NCore; i++) {
+    l1i[i]->outer->connect(l2[0]->inner);
+    l1d[i]->outer->connect(l2[0]->inner);
+  }
+  l2[0]->outer->connect(mem);
+
+  RegressionGen<NCore, true, true, PAddrN, SAddrN, data_type> tg;
+  bool failed = tg.run(TestN, core_inst, core_data);
+  printf("c2-l2-soa: %s\n", failed ? "failed" : "passed");
+
+  delete_caches(l1d);
+  delete_caches(l1i);
+  delete_caches(l2);
+  delete mem;
+  return failed;
+}
@@ -0,0 +1,159 @@
+#ifndef CM_UTIL_ALLOC_HPP
+#define CM_UTIL_ALLOC_HPP
+
+// allocation of large memory blocks used by the cache model
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+
+// size of a (x86-64) huge page, blocks smaller than it gain nothing from huge pages
+constexpr size_t cm_huge_page_size = 2ul<<20;
+
+// huge page policy for large memory blocks (cache arrays, replacer state and the simulated memory)
+enum class CMHugePage {
+  none,    // normal pages only
+  advise,  // advise the kernel to use transparent huge pages (default)
+  hugetlb  // use pre-reserved huge pages (MAP_HUGETLB), fall back to advise when none is available
+};
+
+// the policy applied to the blocks allocated from now on (global)
+inline CMHugePage &cm_huge_page_policy() {
+  static CMHugePage policy = CMHugePage::advise;
+  return policy;
+}
+
+// change the policy for the caches constructed inside a scope (per cache), e.g.
+//   { CMHugePageScope hp(CMHugePage::hugetlb); auto llc = cache_gen_inc<...>(...); }
+class CMHugePageScope
+{
+  const CMHugePage prev;
+public:
+  CMHugePageScope(CMHugePage policy) : prev(cm_huge_page_policy()) { cm_huge_page_policy() = policy; }
+  ~CMHugePageScope() { cm_huge_page_policy() = prev; }
+};
+
+// blocks no smaller than a huge page are rounded to huge pages
+__always_inline size_t cm_block_size(size_t size) {
+  return size < cm_huge_page_size ? size : (size + cm_huge_page_size - 1) & ~(cm_huge_page_size - 1);
+}
+
+// allocate a page aligned (thus also 64B aligned) and zeroed memory block
+// physical pages are not allocated until touched
+inline void *cm_alloc_block(size_t size, CMHugePage policy = cm_huge_page_policy()) {
+  size = cm_block_size(size);
+  bool huge = size >= cm_huge_page_size && policy != CMHugePage::none;
+  void *ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if(huge && policy == CMHugePage::hugetlb) // reserved at mmap(), so it fails early rather than faulting on access
+    ptr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+#endif
+  if(ptr == MAP_FAILED) {
+    ptr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if(ptr == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if(huge) madvise(ptr, size, MADV_HUGEPAGE); // only a hint, normal pages are used when it fails
+#endif
+  }
+  return ptr;
+}
+
+inline void cm_free_block(void *ptr, size_t size) {
+  munmap(ptr, cm_block_size(size));
+}
+
+// an arena holding a fixed number of objects in one contiguous memory block
+// objects are default constructed in place and destructed with the arena
+template<typename T>
+class CMArena
+{
+  T *objs;
+  const size_t num;
+
+public:
+  CMArena(size_t num) : num(num) {
+    objs = static_cast<T *>(cm_alloc_block(num * sizeof(T)));
+    for(size_t i=0; i<num; i++) new(objs + i) T();
+  }
+
+  ~CMArena() {
+    for(size_t i=0; i<num; i++) objs[i].~T();
+    cm_free_block(objs, num * sizeof(T));
+  }
+
+  CMArena(const CMArena &) = delete;
+  CMArena &operator=(const CMArena &) = delete;
+
+  __always_inline T *operator[](size_t i) { return objs + i; }
+  __always_inline const T *operator[](size_t i) const { return objs + i; }
+  __always_inline size_t size() const { return num; }
+};
+
+// no object for a void type (e.g. cache arrays without data)
+template<>
+class CMArena<void>
+{
+public:
+  CMArena(size_t) {}
+  __always_inline void *operator[](size_t) const { return nullptr; }
+  __always_inline size_t size() const { return 0; }
+};
+
+// rows of N elements initialized in pages of 2^PW rows on the first touch of a row (e.g. per-set state of a replacer)
+// all rows start with the same initial row, the rows are reserved in one block and untouched pages take no memory
+// EnMT: pages may be touched by concurrent threads
+template<typename T, int N, bool EnMT, int PW = 6> requires (N > 0) && std::is_trivially_copyable_v<T>
+class CMLazyRows
+{
+  static constexpr uint32_t page_rows = 1u << PW;
+  static constexpr uint8_t page_ready = 2, page_busy = 1;
+  const uint32_t nrow;
+  T *rows;
+  mutable std::vector<std::conditional_t<EnMT, std::atomic<uint8_t>, uint8_t> > pages; // page state
+  std::array<T, N> init_row;
+
+  void init_page(uint32_t p) const {
+    if constexpr (EnMT) {
+      uint8_t expected = 0;
+      if(!pages[p].compare_exchange_strong(expected, page_busy, std::memory_order_acq_rel)) { // initialized by another thread
+        while(pages[p].load(std::memory_order_acquire) != page_ready);
+        return;
+      }
+    }
+    for(uint32_t r = p << PW; r < nrow && r < (p+1) << PW; r++)
+      for(int i=0; i<N; i++) rows[r*N + i] = init_row[i];
+    if constexpr (EnMT) pages[p].store(page_ready, std::memory_order_release);
+    else                pages[p] = page_ready;
+  }
+
+public:
+  CMLazyRows(uint32_t nrow, T v = T())
+    : nrow(nrow), rows(static_cast<T *>(cm_alloc_block(nrow * N * sizeof(T)))), pages((nrow + page_rows - 1) >> PW)
+  {
+    init_row.fill(v);
+  }
+
+  ~CMLazyRows() { cm_free_block(rows, nrow * N * sizeof(T)); }
+
+  CMLazyRows(const CMLazyRows &) = delete;
+  CMLazyRows &operator=(const CMLazyRows &) = delete;
+
+  // set the initial value of an element, must be called before any row is touched
+  void set_init(int i, T v) { init_row[i] = v; }
+
+  __always_inline T *operator[](uint32_t r) const {
+    uint32_t p = r >> PW;
+    bool ready;
+    if constexpr (EnMT) ready = pages[p].load(std::memory_order_acquire) == page_ready;
+    else                ready = pages[p] == page_ready;
+    if(!ready) init_page(p);
+    return rows + r*N;
+  }
+};
+
+#endif
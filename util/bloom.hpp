@@ -0,0 +1,75 @@
+#ifndef CM_UTIL_BLOOM_HPP
+#define CM_UTIL_BLOOM_HPP
+
+// counting Bloom filter, used to filter out definite misses before searching a cache
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// EnMT: the filter is updated by concurrent threads
+// NH: number of hash functions, CR: number of counters per tracked key (rounded up to a power of 2 in total)
+// test() never returns false for a key inserted more times than removed (no false negative),
+// a counter saturates at 255 and is then never decremented to keep it so.
+template<bool EnMT, int NH = 3, int CR = 8> requires (NH > 0 && CR > 0)
+class CMCountingBloom
+{
+  static constexpr uint8_t cnt_max = 255;
+  std::vector<std::conditional_t<EnMT, std::atomic<uint8_t>, uint8_t> > cnt;
+  uint32_t mask;
+
+  // double hashing: the i-th index is h1 + i*h2
+  __always_inline uint64_t hash(uint64_t key) const {
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull; // splitmix64 finalizer
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return key ^ (key >> 31);
+  }
+
+  __always_inline uint32_t index(uint64_t h, int i) const {
+    return ((uint32_t)h + i * ((uint32_t)(h >> 32) | 1u)) & mask;
+  }
+
+  __always_inline void update(uint32_t i, bool inc) {
+    if constexpr (EnMT) {
+      auto v = cnt[i].load(std::memory_order_relaxed);
+      do {
+        if(v == cnt_max || (!inc && v == 0)) return;
+      } while(!cnt[i].compare_exchange_weak(v, inc ? v+1 : v-1, std::memory_order_relaxed));
+    } else {
+      if(cnt[i] == cnt_max || (!inc && cnt[i] == 0)) return;
+      cnt[i] += inc ? 1 : -1;
+    }
+  }
+
+public:
+  // n: maximal number of keys tracked at the same time (e.g. the number of cache lines)
+  CMCountingBloom(uint64_t n) {
+    uint64_t size = 1;
+    while(size < n * CR) size <<= 1;
+    cnt = decltype(cnt)(size);
+    mask = size - 1;
+  }
+
+  void insert(uint64_t key) {
+    auto h = hash(key);
+    for(int i=0; i<NH; i++) update(index(h, i), true);
+  }
+
+  void remove(uint64_t key) {
+    auto h = hash(key);
+    for(int i=0; i<NH; i++) update(index(h, i), false);
+  }
+
+  // false if the key is definitely not in the filter
+  __always_inline bool test(uint64_t key) const {
+    auto h = hash(key);
+    for(int i=0; i<NH; i++) {
+      if constexpr (EnMT) { if(0 == cnt[index(h, i)].load(std::memory_order_relaxed)) return false; }
+      else                { if(0 == cnt[index(h, i)]) return false; }
+    }
+    return true;
+  }
+};
+
+#endif
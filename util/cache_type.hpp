@@ -6,6 +6,7 @@
 #include "cache/exclusive.hpp"
 #include "cache/mirage.hpp"
 #include "cache/dynamic_random.hpp"
+#include "cache/runtime_geometry.hpp"
 #include "cache/mesi.hpp"
 #include "cache/index.hpp"
 #include "cache/replace.hpp"
@@ -40,41 +41,45 @@ namespace ct {
     return std::is_same_v<CPT<false, true, CohPolicyBase>, ExclusiveMESIPolicy<false, true, CohPolicyBase> >;
   }
 
+  // block offset (log2 of the block size) of a data type
+  template<typename DT>
+  constexpr int block_offset() { return __builtin_ctz(cm_data_block_size<DT>()); }
+
   template<bool isDir, typename MTDir, typename MTBCast>
   using metadata_sel_dir = std::conditional_t<isDir, MTDir, MTBCast>;
 
-  template<template <bool, bool, typename> class CPT, typename MT, int IW>
+  template<template <bool, bool, typename> class CPT, typename MT, int IW, int BO = 6>
   using metadata_type =
-    std::conditional_t<is_inc_mi<CPT>(), MetadataMIBroadcast<48, IW, IW+6>,
-    std::conditional_t<is_inc_msi<CPT>() || is_exc_msi<CPT>(), metadata_sel_dir<is_dir<MT>(), MetadataMSIDirectory<48, IW, IW+6>, MetadataMSIBroadcast<48, IW, IW+6> >,
-    std::conditional_t<is_inc_mesi<CPT>() || is_exc_mesi<CPT>(), MetadataMESIDirectory<48, IW, IW+6>,
+    std::conditional_t<is_inc_mi<CPT>(), MetadataMIBroadcast<48, IW, IW+BO>,
+    std::conditional_t<is_inc_msi<CPT>() || is_exc_msi<CPT>(), metadata_sel_dir<is_dir<MT>(), MetadataMSIDirectory<48, IW, IW+BO>, MetadataMSIBroadcast<48, IW, IW+BO> >,
+    std::conditional_t<is_inc_mesi<CPT>() || is_exc_mesi<CPT>(), MetadataMESIDirectory<48, IW, IW+BO>,
                        void> > >;
 
   template<typename Policy, bool isDir, bool EnMT>
   using input_port_exc = std::conditional_t<isDir, ExclusiveInnerCohPortDirectory<Policy, EnMT>,
                                             ExclusiveInnerCohPortBroadcast<Policy, EnMT> >;
 
-  template<typename Policy, bool isL1, bool isDir, bool isExc, bool EnMT>
+  template<typename Policy, bool isL1, bool isDir, bool isExc, bool EnMT, typename CT = CacheBase, int BO = 6>
   using input_port_type =
-    std::conditional_t<isL1, CoreInterface<Policy, EnMT>,
+    std::conditional_t<isL1, CoreInterface<Policy, EnMT, CT, BO>,
     std::conditional_t<isExc, input_port_exc<Policy, isDir, EnMT>,
-                       InnerCohPort<Policy, EnMT> > >;
+                       InnerCohPort<Policy, EnMT, CT> > >;
 
   template<typename Policy, bool isDir, bool EnMT>
   using output_port_exc = std::conditional_t<isDir, ExclusiveOuterCohPortDirectory<Policy, EnMT>,
                                              ExclusiveOuterCohPortBroadcast<Policy, EnMT> >;
 
-  template<typename Policy, bool uncached, bool isDir, bool isExc, bool EnMT>
+  template<typename Policy, bool uncached, bool isDir, bool isExc, bool EnMT, typename CT = CacheBase>
   using output_port_type =
-    std::conditional_t<uncached, OuterCohPortUncached<Policy, EnMT>,
+    std::conditional_t<uncached, OuterCohPortUncached<Policy, EnMT, CT>,
     std::conditional_t<isExc, output_port_exc<Policy, isDir, EnMT>,
-                       OuterCohPort<Policy, EnMT> > >;
+                       OuterCohPort<Policy, EnMT, CT> > >;
 }
 
-template<typename CT>
-inline std::vector<CoherentCacheBase *> cache_generator(int size, const std::string& name_prefix) {
+template<typename CT, typename... Args>
+inline std::vector<CoherentCacheBase *> cache_generator(int size, const std::string& name_prefix, const Args&... args) {
   auto array = std::vector<CoherentCacheBase *>(size);
-  for(int i=0; i<size; i++) array[i] = new CT(name_prefix + (size > 1 ? "-"+std::to_string(i) : ""));
+  for(int i=0; i<size; i++) array[i] = new CT(name_prefix + (size > 1 ? "-"+std::to_string(i) : ""), args...);
   return array;
 }
 
@@ -89,61 +94,118 @@ template<int IW, int WN, int DW, typename DT, typename MT,
          template <int, int, bool, bool, bool> class RPT,
          template <int, int, bool, bool, bool> class DRPT,
          template <bool, bool, typename> class CPT, typename Policy,
-         bool isL1, bool uncached, typename DLY, bool EnMon, bool EnMT>
+         bool isL1, bool uncached, typename DLY, bool EnMon, bool EnMT,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, bool EnSD = false, bool EnMF = false,
+         bool EnDBP = false, bool EnBP = false, int BO = ct::block_offset<DT>()>
 inline auto cache_gen(int size, const std::string& name_prefix) {
-  using index_type = IndexNorm<IW,6>;
+  using index_type = IndexNorm<IW,BO>;
   using replace_type = RPT<IW,WN,true,true,EnMT>;
   using ext_replace_type = DRPT<IW,DW,true,true,EnMT>;
   constexpr bool isDir = ct::is_dir<MT>();
   constexpr bool isExc = ct::is_exc_msi<CPT>() || ct::is_exc_mesi<CPT>();
   static_assert(!(isExc && EnMT), "multithread support ia not available for exclusive caches!");
-  using metadata_type = ct::metadata_type<CPT, MT, IW>;
-  using input_type = ct::input_port_type<Policy, isL1, isDir, isExc, EnMT>;
-  using output_type = ct::output_port_type<Policy, uncached, isDir, isExc, EnMT>;
+  static_assert(!(isExc && EnSD), "static dispatch is not available for exclusive caches!");
+  static_assert(!(isExc && EnMF), "miss filter is not available for exclusive caches!");
+  static_assert(!(isExc && EnDBP), "dead block prediction is not available for exclusive caches!");
+  static_assert(EnDBP || !EnBP, "bypassing dead blocks requires the dead block prediction!");
+  static_assert(C_VOID<DT> || BO == ct::block_offset<DT>(), "the block offset does not match the size of the data block!");
+  using miss_filter_type = std::conditional_t<EnMF, CMCountingBloom<EnMT>, void>; // EnMF: filter out definite misses
+  using dead_pred_type = std::conditional_t<EnDBP, DBPredictorSHiP<EnBP, EnMT>, void>; // EnDBP: predict dead blocks, EnBP: bypass them
+  using metadata_type = ct::metadata_type<CPT, MT, IW, BO>;
   using cache_base_type =
     std::conditional_t<isExc,
     std::conditional_t<isDir,
-      CacheNormExclusiveDirectory<IW, WN, DW, metadata_type, DT, index_type, replace_type, ext_replace_type, DLY, EnMon>,
-      CacheNormExclusiveBroadcast<IW, WN,     metadata_type, DT, index_type, replace_type,                   DLY, EnMon> >,
-                        CacheNorm<IW, WN,     metadata_type, DT, index_type, replace_type,                   DLY, EnMon, EnMT> >;
+      CacheNormExclusiveDirectory<IW, WN, DW, metadata_type, DT, index_type, replace_type, ext_replace_type, DLY, EnMon, CAT>,
+      CacheNormExclusiveBroadcast<IW, WN,     metadata_type, DT, index_type, replace_type,                   DLY, EnMon, CAT> >,
+                        CacheNorm<IW, WN,     metadata_type, DT, index_type, replace_type,                   DLY, EnMon, EnMT, 4, CAT, miss_filter_type, dead_pred_type> >;
 
-  using cache_type = CoherentCacheNorm<cache_base_type, output_type, input_type>;
+  // EnSD: seal the cache type and let the ports call it with static dispatch
+  using cache_sealed_type = std::conditional_t<EnSD, CacheStatic<cache_base_type>, cache_base_type>;
+  using port_cache_type = std::conditional_t<EnSD, cache_sealed_type, CacheBase>;
+  using input_type = ct::input_port_type<Policy, isL1, isDir, isExc, EnMT, port_cache_type, BO>;
+  using output_type = ct::output_port_type<Policy, uncached, isDir, isExc, EnMT, port_cache_type>;
+  using cache_type = CoherentCacheNorm<cache_sealed_type, output_type, input_type>;
   return cache_generator<cache_type>(size, name_prefix);
 }
 
 template<int IW, int WN, typename DT, typename MT,
          template <int, int, bool, bool, bool> class RPT,
          template <bool, bool, typename> class CPT, typename Policy,
-         bool uncached, typename DLY, bool EnMon, bool EnMT = false>
+         bool uncached, typename DLY, bool EnMon, bool EnMT = false,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, bool EnSD = false, bool EnMF = false,
+         bool EnDBP = false, bool EnBP = false, int BO = ct::block_offset<DT>()>
 inline auto cache_gen_l1(int size, const std::string& name_prefix) {
-  return cache_gen<IW, WN, 1, DT, MT, RPT, ReplaceLRU, CPT, Policy, true, uncached, DLY, EnMon, EnMT>(size, name_prefix);
+  return cache_gen<IW, WN, 1, DT, MT, RPT, ReplaceLRU, CPT, Policy, true, uncached, DLY, EnMon, EnMT, CAT, EnSD, EnMF, EnDBP, EnBP, BO>(size, name_prefix);
 }
 
 template<int IW, int WN, typename DT, typename MT,
          template <int, int, bool, bool, bool> class RPT,
          template <bool, bool, typename> class CPT, typename Policy,
-         bool uncached, typename DLY, bool EnMon, bool EnMT = false>
+         bool uncached, typename DLY, bool EnMon, bool EnMT = false,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, bool EnSD = false, bool EnMF = false,
+         bool EnDBP = false, bool EnBP = false, int BO = ct::block_offset<DT>()>
 inline auto cache_gen_inc(int size, const std::string& name_prefix) {
-  return cache_gen<IW, WN, 1, DT, MT, RPT, ReplaceLRU, CPT, Policy, false, uncached, DLY, EnMon, EnMT>(size, name_prefix);
+  return cache_gen<IW, WN, 1, DT, MT, RPT, ReplaceLRU, CPT, Policy, false, uncached, DLY, EnMon, EnMT, CAT, EnSD, EnMF, EnDBP, EnBP, BO>(size, name_prefix);
 }
 
 template<int IW, int WN, typename DT, typename MT,
          template <int, int, bool, bool, bool> class RPT,
          template <bool, bool, typename> typename CPT, typename Policy,
-         bool uncached, typename DLY, bool EnMon>
+         bool uncached, typename DLY, bool EnMon,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, int BO = ct::block_offset<DT>()>
 inline auto cache_gen_exc(int size, const std::string& name_prefix) {
   static_assert(ct::is_exc_msi<CPT>());
-  return cache_gen<IW, WN, 1, DT, MT, RPT, ReplaceLRU, CPT, Policy, false, uncached, DLY, EnMon, false>(size, name_prefix);
+  return cache_gen<IW, WN, 1, DT, MT, RPT, ReplaceLRU, CPT, Policy, false, uncached, DLY, EnMon, false, CAT, false, false, false, false, BO>(size, name_prefix);
 }
 
 template<int IW, int WN, int DW, typename DT, typename MT,
          template <int, int, bool, bool, bool> class RPT,
          template <int, int, bool, bool, bool> class DRPT,
          template <bool, bool, typename> class CPT, typename Policy,
-         bool uncached, typename DLY, bool EnMon>
+         bool uncached, typename DLY, bool EnMon,
+         template <int, int, typename, typename, bool> class CAT = CacheArrayNorm, int BO = ct::block_offset<DT>()>
 inline auto cache_gen_exc(int size, const std::string& name_prefix) {
   static_assert(ct::is_exc_mesi<CPT>() && ct::is_dir<MT>());
-  return cache_gen<IW, WN, DW, DT, MT, RPT, DRPT, CPT, Policy, false, uncached, DLY, EnMon, false>(size, name_prefix);
+  return cache_gen<IW, WN, DW, DT, MT, RPT, DRPT, CPT, Policy, false, uncached, DLY, EnMon, false, CAT, false, false, false, false, BO>(size, name_prefix);
+}
+
+// caches with the geometry decided at run time (no exclusive cache)
+// IDX: IndexNormRT for set associative caches, IndexSkewedRT for skewed caches (its index offset should be BO)
+// BO: block offset, log2 of the block size
+template<typename DT, typename MT,
+         template <int, int, bool, bool, bool> class RPT,
+         template <bool, bool, typename> class CPT, typename Policy,
+         bool isL1, bool uncached, typename DLY, bool EnMon, bool EnMT = false,
+         typename IDX = IndexNormRT<ct::block_offset<DT>()>, int BO = ct::block_offset<DT>()>
+inline auto cache_gen_rt(int size, const std::string& name_prefix, const CacheGeometry &geo) {
+  using replace_type = ReplaceRT<RPT, true, true, EnMT>;
+  constexpr bool isDir = ct::is_dir<MT>();
+  static_assert(!ct::is_exc_msi<CPT>() && !ct::is_exc_mesi<CPT>(), "exclusive caches are not supported with the geometry decided at run time!");
+  static_assert(C_VOID<DT> || BO == ct::block_offset<DT>(), "the block offset does not match the size of the data block!");
+  using metadata_type = ct::metadata_type<CPT, MT, 0, BO>; // the tag includes the index bits
+  using cache_base_type = CacheSkewedRT<metadata_type, DT, IDX, replace_type, DLY, EnMon, EnMT>;
+  using input_type = ct::input_port_type<Policy, isL1, isDir, false, EnMT, CacheBase, BO>;
+  using output_type = ct::output_port_type<Policy, uncached, isDir, false, EnMT>;
+  using cache_type = CoherentCacheNorm<cache_base_type, output_type, input_type>;
+  return cache_generator<cache_type>(size, name_prefix, geo);
+}
+
+template<typename DT, typename MT,
+         template <int, int, bool, bool, bool> class RPT,
+         template <bool, bool, typename> class CPT, typename Policy,
+         bool uncached, typename DLY, bool EnMon, bool EnMT = false,
+         typename IDX = IndexNormRT<ct::block_offset<DT>()>, int BO = ct::block_offset<DT>()>
+inline auto cache_gen_l1_rt(int size, const std::string& name_prefix, const CacheGeometry &geo) {
+  return cache_gen_rt<DT, MT, RPT, CPT, Policy, true, uncached, DLY, EnMon, EnMT, IDX, BO>(size, name_prefix, geo);
+}
+
+template<typename DT, typename MT,
+         template <int, int, bool, bool, bool> class RPT,
+         template <bool, bool, typename> class CPT, typename Policy,
+         bool uncached, typename DLY, bool EnMon, bool EnMT = false,
+         typename IDX = IndexNormRT<ct::block_offset<DT>()>, int BO = ct::block_offset<DT>()>
+inline auto cache_gen_inc_rt(int size, const std::string& name_prefix, const CacheGeometry &geo) {
+  return cache_gen_rt<DT, MT, RPT, CPT, Policy, false, uncached, DLY, EnMon, EnMT, IDX, BO>(size, name_prefix, geo);
 }
 
 namespace ct {
@@ -152,13 +214,13 @@ namespace ct {
              template <int, int, bool, bool, bool> class MRPT,
              template <int, int, bool, bool, bool> class DRPT,
              typename Outer,
-             typename DLY, bool EnMon, bool EnableRelocation>
+             typename DLY, bool EnMon, bool EnableRelocation, typename HT = CMHasher, int BO = block_offset<DT>()>
     struct types {
-      using meta_index_type = IndexSkewed<IW, 6, P>;
-      using data_index_type = IndexRandom<IW, 6>;
+      using meta_index_type = IndexSkewed<IW, BO, P, HT>;
+      using data_index_type = IndexRandom<IW, BO, HT>;
       using meta_replace_type = MRPT<IW, WN+EW, true, true, false>;
       using data_replace_type = DRPT<IW, WN*P, true, true, false>;
-      using meta_metadata_type = MirageMetadataMSIBroadcast<48,0,6>;
+      using meta_metadata_type = MirageMetadataMSIBroadcast<48,0,BO>;
       using data_metadata_type = MirageDataMeta;
       using cache_base_type = MirageCache<IW, WN, EW, P,
                                           meta_metadata_type, DT, data_metadata_type,
@@ -181,13 +243,13 @@ namespace ct {
     template<int IW, int WN, typename DT,
              template <int, int, bool, bool, bool> class RPT,
              typename Outer,
-             typename DLY, bool EnMon>
+             typename DLY, bool EnMon, typename HT = CMHasher, int BO = block_offset<DT>()>
     struct types {
-      using index_type = IndexRandom<IW, 6>;
+      using index_type = IndexRandom<IW, BO, HT>;
       using replace_type = RPT<IW, WN, true, true, false>;
-      using metadata_base_type = MetadataMSIBroadcast<48,0,0+6>;
+      using metadata_base_type = MetadataMSIBroadcast<48,0,0+BO>;
       using metadata_type = MetadataWithRelocate<metadata_base_type>;
-      using cache_base_type = CacheRemap<IW, WN, 1, metadata_type, DT, index_type, replace_type, DLY, EnMon>;
+      using cache_base_type = CacheRemap<IW, WN, 1, metadata_type, DT, index_type, replace_type, DLY, EnMon, BO>;
       using policy_type = MSIPolicy<false, true, Outer>;
       using input_type = InnerCohPortRemapT<cache_base_type, metadata_type, policy_type>;
       using output_type = OuterCohPortUncached<policy_type, false>;
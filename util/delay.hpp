@@ -8,6 +8,8 @@ public:
   virtual void write(uint64_t addr, int32_t ai, int32_t s, int32_t w, bool hit, uint64_t *delay) = 0;
   // probe, invalidate and writeback
   virtual void manage(uint64_t addr, int32_t ai, int32_t s, int32_t w, bool hit, bool evict, bool writeback, uint64_t *delay) = 0;
+  // a read miss granted without being allocated in the cache, costs a read miss by default
+  virtual void bypass(uint64_t addr, uint64_t *delay) { read(addr, -1, -1, -1, false, delay); }
 };
 
 // L1 delay estimation
@@ -65,6 +67,9 @@ public:
 
   // hidden
   virtual void manage(uint64_t addr, int32_t ai, int32_t s, int32_t w, bool hit, bool evict, bool writeback, uint64_t *delay) override {}
+
+  // never allocates
+  virtual void bypass(uint64_t addr, uint64_t *delay) override {}
 };
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef CM_UTIL_FASTMOD_HPP
+#define CM_UTIL_FASTMOD_HPP
+
+// remainder computed by multiplications instead of a division,
+// also faster than the code a compiler generates for a 64-bit remainder by a constant
+// see Lemire et al., Faster remainder by direct computation, https://arxiv.org/abs/1902.01961
+
+#include <cstdint>
+
+class CMFastMod
+{
+  __uint128_t m; // ceil(2^128 / d)
+  uint64_t d;
+
+public:
+  constexpr CMFastMod(uint64_t d) : m(~static_cast<__uint128_t>(0) / d + 1), d(d) {}
+
+  // a % d for any 64-bit a
+  constexpr __always_inline uint64_t operator() (uint64_t a) const {
+    __uint128_t frac = m * a; // the fractional part of a / d scaled by 2^128
+    __uint128_t lo = ((frac & ~0ull) * d) >> 64;
+    return (lo + (frac >> 64) * d) >> 64;
+  }
+
+  constexpr uint64_t divisor() const { return d; }
+};
+
+#endif
@@ -29,6 +29,8 @@ public:
   virtual void write(uint64_t cache_id, uint64_t addr, int32_t ai, int32_t s, int32_t w, int32_t ev_rank, bool hit, const CMMetadataBase *meta, const CMDataBase *data) = 0;
   virtual void invalid(uint64_t cache_id, uint64_t addr, int32_t ai, int32_t s, int32_t w, int32_t ev_rank, const CMMetadataBase *meta, const CMDataBase *data) = 0;
   virtual bool magic_func(uint64_t cache_id, uint64_t addr, uint64_t magic_id, void *magic_data) { return false; } // a special function to log non-standard information to a special monitor
+  virtual void bypass(uint64_t cache_id, uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data) {} // a read miss granted without being allocated (no set or way)
+  virtual bool use_ev_rank() const { return true; } // whether ev_rank is read, a monitor not reading it returns false so the cache may skip computing it (passing -1)
 
   // control
   virtual void start() = 0;    // start the monitor, assuming the monitor is just initialized
@@ -46,6 +48,7 @@ class MonitorContainerBase
 protected:
   const uint32_t id;                    // a unique id to identify the attached cache
   std::set<MonitorBase *> monitors;     // performance moitors
+  bool ev_rank_used = false;            // whether any attached monitor reads the eviction rank
 
 public:
   MonitorContainerBase(uint32_t id) : id(id) {}
@@ -54,11 +57,14 @@ public:
   virtual void attach_monitor(MonitorBase *m) = 0;
 
   // support run-time assign/reassign mointors
-  void detach_monitor() { monitors.clear(); }
+  void detach_monitor() { monitors.clear(); ev_rank_used = false; }
+
+  __always_inline bool need_ev_rank() const { return ev_rank_used; }
 
   virtual void hook_read(uint64_t addr, int32_t ai, int32_t s, int32_t w, int32_t ev_rank, bool hit, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay, unsigned int genre = 0) = 0;
   virtual void hook_write(uint64_t addr, int32_t ai, int32_t s, int32_t w, int32_t ev_rank, bool hit, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay, unsigned int genre = 0) = 0;
   virtual void hook_manage(uint64_t addr, int32_t ai, int32_t s, int32_t w, int32_t ev_rank, bool hit, bool evict, bool writeback, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay, unsigned int genre = 0) = 0;
+  virtual void hook_bypass(uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) = 0;
   virtual void magic_func(uint64_t addr, uint64_t magic_id, void *magic_data) = 0; // an interface for special communication with a specific monitor if attached
   virtual void pause() = 0;
   virtual void resume() = 0;
@@ -75,6 +81,10 @@ public:
   virtual void hook_write(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) = 0;
   // probe, invalidate and writeback
   virtual void hook_manage(uint64_t addr, uint32_t ai, uint32_t s, uint32_t w, bool hit, uint32_t evict, bool writeback, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) = 0;
+  // a read miss granted without being allocated in the cache (no-allocate path)
+  virtual void hook_bypass(uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) {
+    monitors->hook_bypass(addr, meta, data, delay);
+  }
   // an interface for special communication with a specific monitor if attached
   __always_inline void monitor_magic_func(uint64_t addr, uint64_t magic_id, void *magic_data) {
     monitors->magic_func(addr, magic_id, magic_data);
@@ -83,7 +93,7 @@ public:
 
 // Cache monitor and delay support
 template<typename DLY, bool EnMon>
-class CacheMonitorImp : public MonitorContainerBase
+class CacheMonitorImp final : public MonitorContainerBase
 {
 protected:
   DLY *timer;                           // delay estimator
@@ -99,7 +109,10 @@ public:
 
   virtual void attach_monitor(MonitorBase *m) override {
     if constexpr (EnMon) {
-      if(m->attach(id)) monitors.insert(m);
+      if(m->attach(id)) {
+        monitors.insert(m);
+        if(m->use_ev_rank()) ev_rank_used = true;
+      }
     }
   }
 
@@ -120,6 +133,11 @@ public:
     if constexpr (!C_VOID<DLY>) timer->manage(addr, ai, s, w, hit, evict, writeback, delay);
   }
 
+  virtual void hook_bypass(uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data, uint64_t *delay) override {
+    if constexpr (EnMon) for(auto m:monitors) m->bypass(id, addr, meta, data);
+    if constexpr (!C_VOID<DLY>) timer->bypass(addr, delay);
+  }
+
   virtual void magic_func(uint64_t addr, uint64_t magic_id, void *magic_data) {
     if constexpr (EnMon) {
       for(auto m:monitors)
@@ -145,13 +163,14 @@ public:
 class SimpleAccMonitor : public MonitorBase
 {
 protected:
-  uint64_t cnt_access = 0, cnt_miss = 0, cnt_write = 0, cnt_write_miss = 0, cnt_invalid = 0;
+  uint64_t cnt_access = 0, cnt_miss = 0, cnt_write = 0, cnt_write_miss = 0, cnt_invalid = 0, cnt_bypass = 0;
   bool active;
 
 public:
   SimpleAccMonitor(bool active = false) : active(active) {}
 
   virtual bool attach(uint64_t cache_id) override { return true; }
+  virtual bool use_ev_rank() const override { return false; }
 
   virtual void read(uint64_t cache_id, uint64_t addr, int32_t ai, int32_t s, int32_t w, int32_t ev_rank, bool hit, const CMMetadataBase *meta, const CMDataBase *data)  override {
     if(!active) return;
@@ -174,6 +193,13 @@ public:
     cnt_invalid++;
   }
 
+  virtual void bypass(uint64_t cache_id, uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data) override {
+    if(!active) return;
+    cnt_access++;
+    cnt_miss++;
+    cnt_bypass++;
+  }
+
   virtual void start() { active = true;  }
   virtual void stop()  { active = false; }
   virtual void pause() { active = false; }
@@ -184,6 +210,7 @@ public:
     cnt_write = 0;
     cnt_write_miss = 0;
     cnt_invalid = 0;
+    cnt_bypass = 0;
     active = false;
   }
 
@@ -195,6 +222,7 @@ public:
   uint64_t get_miss_read() { return cnt_miss - cnt_write_miss; }
   uint64_t get_miss_write() { return cnt_write_miss; }
   uint64_t get_invalid() { return cnt_invalid; }
+  uint64_t get_bypass() { return cnt_bypass; }
 };
 
 // a tracer
@@ -255,6 +283,21 @@ public:
 
     print(msg);
   }
+  virtual void bypass(uint64_t cache_id, uint64_t addr, const CMMetadataBase *meta, const CMDataBase *data) override {
+    if(!active) return;
+    std::string msg;  msg.reserve(100);
+    msg += (boost::format("%-10s bypss %016x             0") % UniqueID::name(cache_id) % addr).str();
+
+    if(meta)
+      msg.append(" [").append(meta->to_string()).append("]");
+    else if(data)
+      msg.append("      ");
+
+    if(data)
+      msg.append(" ").append(compact_data ? (boost::format("%016x") % (data->read(0))).str() : data->to_string());
+
+    print(msg);
+  }
 
   virtual void start() override { active = true;  }
   virtual void stop()  override { active = false; }
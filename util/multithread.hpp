@@ -19,6 +19,13 @@
 #include <boost/stacktrace.hpp>
 #endif
 
+// a small index of the calling thread, assigned on its first call (e.g. to pick a per-thread slot of striped counters)
+inline uint32_t cm_thread_slot() {
+  static std::atomic<uint32_t> next(0);
+  static thread_local uint32_t slot = next.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
 template<typename T>
 class AtomicVar final {
   std::unique_ptr<std::atomic<T> > var;
@@ -59,24 +66,36 @@ public:
   }
 };
 
+// a plain 64-bit word shared by threads when EnMT (e.g. a word of packed state in memory initialized by copy),
+// it is read atomically and updated by f with a lock-free compare-and-swap loop
+template<bool EnMT>
+__always_inline uint64_t cm_load_word(const uint64_t &word) {
+  if constexpr (EnMT) return __atomic_load_n(&word, __ATOMIC_RELAXED);
+  else                return word;
+}
+
+template<bool EnMT, typename F>
+__always_inline void cm_update_word(uint64_t &word, F f) {
+  if constexpr (EnMT) {
+    uint64_t v = __atomic_load_n(&word, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n(&word, &v, f(v), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  } else
+    word = f(word);
+}
+
 // a database for recoridng the pending transactions
 
 class CMMetadataBase; // forward declaration
 
 template<bool EnMT, int MSHR = 16>
 class PendingXact final {
-  std::vector<std::tuple<uint64_t, bool, CMMetadataBase *, uint32_t, uint32_t> > xact;
+  // the id is kept apart from the address as a block smaller than 64B has fewer than 6 free offset bits
+  std::vector<std::tuple<uint64_t, int32_t, bool, CMMetadataBase *, uint32_t, uint32_t> > xact;
   std::vector<bool> valid;
   std::mutex mtx;
 
-  __always_inline uint64_t key(uint64_t addr, int32_t id) {
-    assert(id < 63 || 0 == "We do not support more than 63 coherent inner cache for any cache level!");
-    return addr | (id & 0x3f);
-  }
-
   __always_inline int find(uint64_t addr, int32_t id) {
-    auto k = key(addr, id);
-    for(int i=0; i<MSHR; i++) if(valid[i] && k == std::get<0>(xact[i])) return i;
+    for(int i=0; i<MSHR; i++) if(valid[i] && addr == std::get<0>(xact[i]) && id == std::get<1>(xact[i])) return i;
     return -1;
   }
 
@@ -93,7 +112,7 @@ public:
     for(int i=0; i<MSHR; i++) if(!valid[i]) { index = i; break; }
     assert(index < MSHR || 0 == "Pending transaction queue for finish message overflow!");
     valid[index] = true;
-    xact[index] = std::make_tuple(key(addr, id), forward, meta, ai, s);
+    xact[index] = std::make_tuple(addr, id, forward, meta, ai, s);
   }
 
   void remove(uint64_t addr, int32_t id) {
@@ -107,7 +126,7 @@ public:
     std::lock_guard lk(mtx);
     auto index = find(addr, id);
     if(index >= 0) {
-      auto [key, forward, meta, ai, s] = xact[index];
+      auto [xaddr, xid, forward, meta, ai, s] = xact[index];
       return std::make_tuple(true, forward, meta, ai, s);
     } else
       return std::make_tuple(false, false, nullptr, 0, 0);
@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <memory>
 #include <mutex>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <queue>
@@ -14,6 +15,7 @@
 #include "util/regression.hpp"
 #include <thread>
 
+template<typename DT>
 class cache_xact 
 {
 public:
@@ -22,7 +24,7 @@ public:
   bool ic;
   int flush;
   uint64_t addr;
-  Data64B data;
+  DT data;
 };
 
 /** 
@@ -30,11 +32,12 @@ public:
  * thread's data was last saved in the cache (depending on who wrote it later), so all possible 
  * data will be saved for checking
  */
+template<typename DT>
 class DataQueue
 {
 protected:
   uint64_t addr;
-  std::deque<Data64B> data_deque;
+  std::deque<DT> data_deque;
   std::mutex* mtx;
   unsigned int NC;
 public:
@@ -44,7 +47,7 @@ public:
   virtual ~DataQueue() { delete mtx; }
 
   void write(const CMDataBase* wdata){
-    Data64B tdata;
+    DT tdata;
     tdata.copy(wdata);
     std::unique_lock lk(*mtx);
     data_deque.push_back(tdata);
@@ -54,18 +57,19 @@ public:
     assert(caddr == addr);
     std::unique_lock lk(*mtx);
     if(data_deque.size() == 0 || data->read(0) == 0) return true;
-    for(auto d : data_deque){
+    for(auto &d : data_deque){
       if(d.read(0) == data->read(0)) return true;
     }
     return false;
   }
 };
 
+template<typename DT>
 class ParallelRegressionSupport
 {
 public:
   virtual void xact_queue_add(int test_num) = 0;
-  virtual std::pair<bool, cache_xact> get_xact(int core) = 0;
+  virtual std::pair<bool, cache_xact<DT> > get_xact(int core) = 0;
   virtual bool check(uint64_t addr, const CMDataBase *data) = 0;
   virtual void write_dq(uint64_t addr, CMDataBase* data) = 0;
 };
@@ -75,6 +79,7 @@ template<int NC, bool EnIC, bool TestFlush, unsigned int PAddrN, unsigned int SA
 class ParallelRegressionGen : public RegressionGen<NC, EnIC, TestFlush, PAddrN, SAddrN, DT>
 {
   typedef RegressionGen<NC, EnIC, TestFlush, PAddrN, SAddrN, DT> ReT;
+  typedef std::conditional_t<C_VOID<DT>, Data64B, DT> XDT; // data block of a transaction, unused when DT is void
 protected:
   using ReT::addr_pool;
   using ReT::addr_map;
@@ -85,8 +90,8 @@ protected:
   using ReT::gi;
   using ReT::gen;
 
-  std::vector<DataQueue* > dq_pool;
-  std::vector<std::deque<cache_xact >> xact_queue;
+  std::vector<DataQueue<XDT>* > dq_pool;
+  std::vector<std::deque<cache_xact<XDT> >> xact_queue;
   std::vector<std::mutex *> xact_mutux;
   std::vector<std::condition_variable *> xact_cond;
 public:
@@ -94,7 +99,7 @@ public:
     xact_queue.resize(NC);
     dq_pool.resize(addr_pool.size());
     for(unsigned int i = 0; i < addr_pool.size(); i++){
-      dq_pool[i] = new DataQueue(NC, addr_pool[i]);
+      dq_pool[i] = new DataQueue<XDT>(NC, addr_pool[i]);
     }
     xact_mutux.resize(NC);
     xact_cond.resize(NC);
@@ -111,14 +116,13 @@ public:
   }
 
   virtual void xact_queue_add(int test_num){
-    cache_xact act;
+    cache_xact<XDT> act;
     int num = 0;
     act.core = hasher(gi++) % NC;
     while(num < test_num){
       auto [addr, data, rw, core, ic, flush] = gen();
-      Data64B d;
-      if constexpr (!C_VOID<DT>) d.copy(data);
-      act = cache_xact{rw, core, ic, flush, addr, d};
+      act = cache_xact<XDT>{rw, core, ic, flush, addr, {}};
+      if constexpr (!C_VOID<DT>) act.data.copy(data);
       if(flush == 2){ // share instruction flush
         for(int i = 0; i < NC; i++){
           if(i == core) continue;
@@ -146,9 +150,9 @@ public:
     xact_queue_add(test_num);
   }
 
-  virtual std::pair<bool, cache_xact> get_xact(int core){
+  virtual std::pair<bool, cache_xact<XDT> > get_xact(int core){
     std::unique_lock lk(*xact_mutux[core]);
-    cache_xact act;
+    cache_xact<XDT> act;
     if(xact_queue[core].empty()) return std::make_pair(false, act);
     else{
       act = xact_queue[core].front();
@@ -167,6 +171,7 @@ public:
 
   void cache_server(int core, std::vector<CoreInterfaceBase *>* core_inst, std::vector<CoreInterfaceBase *>* core_data, bool* exit)
   {
+    cm_set_thread_id(core);
     while(true){
       auto act = get_xact(core);
       if(*exit && !act.first) break;
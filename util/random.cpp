@@ -1,4 +1,6 @@
 #include "util/random.hpp"
+#include <atomic>
+#include <mutex>
 #include <random>
 #include <type_traits>
 
@@ -34,19 +36,36 @@ namespace {
   RandomGenDeault<uint32_t, (1ull<<31)> g_gen32;
   RandomGenDeault<uint64_t, (1ull<<63)> g_gen64;
 #endif
+  std::mutex g_gen_mutex; // the global generators are shared by all threads
+  // the seed base and the next default id of per-thread generators
+#ifdef NDEBUG
+  std::atomic<uint64_t> g_seed_base(((uint64_t)rd() << 32) | rd());
+#else
+  std::atomic<uint64_t> g_seed_base(0x243f6a8885a308d3ull);
+#endif
+  std::atomic<uint64_t> g_thread_id_next(1ull << 32); // above any id given by cm_set_thread_id()
 
 }
 
-unsigned int cm_get_true_random() { return rd(); }
-void cm_set_random_seed(uint64_t seed) { g_gen32.seed(seed); g_gen64.seed(seed); }
-uint64_t cm_get_random_uint64() { return g_gen64(); }
-uint32_t cm_get_random_uint32() { return g_gen32(); }
+unsigned int cm_get_true_random() { std::lock_guard lock(g_gen_mutex); return rd(); }
+void cm_set_random_seed(uint64_t seed) {
+  {
+    std::lock_guard lock(g_gen_mutex);
+    g_gen32.seed(seed); g_gen64.seed(seed); g_seed_base = seed;
+  }
+  auto &t = cm_random_thread();
+  t.gen.seed(seed + t.id);
+}
+uint64_t cm_get_random_seed_base() { return g_seed_base; }
+uint64_t cm_new_thread_id() { return g_thread_id_next++; }
+uint64_t cm_get_random_uint64() { std::lock_guard lock(g_gen_mutex); return g_gen64(); }
+uint32_t cm_get_random_uint32() { std::lock_guard lock(g_gen_mutex); return g_gen32(); }
 
 // allocate localized random number generator, normally for the multi-thread use case
 #ifdef NDEBUG
   // release mode
-  RandomGen<uint32_t> *cm_alloc_rand32() { return new RandomGenMT<uint32_t, (1ull<<31)>(rd()); }
-  RandomGen<uint64_t> *cm_alloc_rand64() { return new RandomGenMT<uint64_t, (1ull<<63)>(rd()); }
+  RandomGen<uint32_t> *cm_alloc_rand32() { return new RandomGenMT<uint32_t, (1ull<<31)>(cm_get_true_random()); }
+  RandomGen<uint64_t> *cm_alloc_rand64() { return new RandomGenMT<uint64_t, (1ull<<63)>(cm_get_true_random()); }
 #else
   RandomGen<uint32_t> *cm_alloc_rand32() { return new RandomGenDeault<uint32_t, (1ull<<31)>(); }
   RandomGen<uint64_t> *cm_alloc_rand64() { return new RandomGenDeault<uint64_t, (1ull<<63)>(); }
@@ -2,7 +2,11 @@
 #define CM_UTIL_RANDOM_HPP_
 
 #include <cstdint>
+#include <cstring>
+#include <random>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <string>
 
 template<typename rv_type>
@@ -14,39 +18,330 @@ public:
 };
 
 extern unsigned int cm_get_true_random();
-extern void cm_set_random_seed(uint64_t seed);
-extern uint64_t cm_get_random_uint64();
+extern void cm_set_random_seed(uint64_t seed); // also the seed base of the per-thread generators, reseeds the calling thread
+extern uint64_t cm_get_random_seed_base();      // fixed in debug mode, true random in release mode
+extern uint64_t cm_new_thread_id();             // a distinct default id of a per-thread generator
+extern uint64_t cm_get_random_uint64(); // global generators, thread safe
 extern uint32_t cm_get_random_uint32();
 extern RandomGen<uint32_t> *cm_alloc_rand32(); // generate a local random generator for a thread
 extern RandomGen<uint64_t> *cm_alloc_rand64();
 
+// xoshiro256++, a small and fast generator for the hot path of the simulation (non-virtual and inlined)
+// see https://prng.di.unimi.it/
+class CMRandom final {
+  uint64_t st[4];
+
+  static __always_inline uint64_t rotl(uint64_t v, int b) { return (v << b) | (v >> (64 - b)); }
+
+public:
+  CMRandom(uint64_t s) { seed(s); }
+
+  void seed(uint64_t s) {
+    for(auto &v : st) { // splitmix64
+      s += 0x9e3779b97f4a7c15ull;
+      v = (s ^ (s >> 30)) * 0xbf58476d1ce4e5b9ull;
+      v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+      v ^= v >> 31;
+    }
+  }
+
+  __always_inline uint64_t operator ()() {
+    uint64_t rv = rotl(st[0] + st[3], 23) + st[0];
+    uint64_t t = st[1] << 17;
+    st[2] ^= st[0]; st[3] ^= st[1]; st[1] ^= st[2]; st[0] ^= st[3];
+    st[2] ^= t;     st[3] = rotl(st[3], 45);
+    return rv;
+  }
+
+  // uniform in [0, range) without bias, using Lemire's multiply-shift reduction
+  // (a division only when a rejection may be needed, which is rare for a small range)
+  // see https://arxiv.org/abs/1805.10941
+  __always_inline uint32_t operator ()(uint32_t range) {
+    uint64_t m = ((*this)() >> 32) * range;
+    if((uint32_t)m < range) {
+      uint32_t t = -range % range;
+      while((uint32_t)m < t) m = ((*this)() >> 32) * range;
+    }
+    return m >> 32;
+  }
+};
+
+// the generator of the calling thread, seeded from the seed base plus the id of the thread
+// a thread is given a distinct default id (above 2^32) when it first draws, so concurrent threads never share a sequence,
+// but the default ids depend on the order in which threads start, call cm_set_thread_id() for reproducible runs
+struct CMRandomThread {
+  uint64_t id = cm_new_thread_id();
+  CMRandom gen{cm_get_random_seed_base() + id};
+};
+
+inline CMRandomThread &cm_random_thread() {
+  static thread_local CMRandomThread t;
+  return t;
+}
+
+inline CMRandom &cm_random() { return cm_random_thread().gen; }
+
+// identify the calling simulation thread (e.g. by the core it simulates) and reseed its generator,
+// concurrent threads should use different ids or they draw the same sequence
+inline void cm_set_thread_id(uint32_t id) {
+  auto &t = cm_random_thread();
+  t.id = id;
+  t.gen.seed(cm_get_random_seed_base() + id);
+}
+
+// the local randomizer of a simulation object (a skewed cache, a random replacer, etc.)
+// a single-thread debug build replays the sequence of the per-object generator it used to allocate by cm_alloc_rand32()
+// (a default seeded std::default_random_engine), so the expected logs of the regression tests stay valid,
+// otherwise the numbers are drawn from the generator of the calling thread (cm_random())
+template<bool EnMT>
+class CMRandomLocal final {
+#ifdef NDEBUG
+  static constexpr bool replay = false;
+#else
+  static constexpr bool replay = !EnMT;
+#endif
+  struct Replay { std::default_random_engine gen; std::uniform_int_distribution<uint32_t> uniform{0, 1u << 31}; };
+  struct Forward {};
+  std::conditional_t<replay, Replay, Forward> st;
+
+public:
+  // a number in [0, range)
+  __always_inline uint32_t operator ()(uint32_t range) {
+    if constexpr (replay) return st.uniform(st.gen) % range;
+    else                  return cm_random()(range);
+  }
+};
+
 #include "cryptopp/cryptlib.h"
 #include "cryptopp/tiger.h"
+#include "util/simd.hpp"
 
-// see https://cryptopp.com/wiki/Tiger
+// keyed hashers used by randomized indexers (e.g. IndexSkewed), all of them provide
+//   a default constructor (randomly seeded), a constructor with a seed,
+//   uint64_t operator () (uint64_t data) and void seed(uint64_t s)
+// the fast ones also hash a batch of words using SIMD:
+//   void operator () (const uint64_t *data, uint64_t *rv, unsigned int n)
 
+// Tiger (cryptographic, slow), the default hasher for bit-exact reproduction of previous results
+// see https://cryptopp.com/wiki/Tiger
+// The 16-byte message (data, seed) fits in one block, so the padded block is prepared by seed()
+// and a hash is one call of the compression function on local state, which is safe for concurrent threads.
 class CMHasher final {
-  uint8_t msg[16];
-  uint8_t result[8];
-  CryptoPP::Tiger hasher;
+  CryptoPP::word64 block[8]; // data, seed, padding (0x01) and the message length in bits (little endian)
+
+public:
+  CMHasher() { seed(cm_get_random_uint64()); }
+  CMHasher(uint64_t s) { seed(s); }
+
+  uint64_t operator () (uint64_t data) const {
+    CryptoPP::word64 msg[8], digest[3];
+    memcpy(msg, block, sizeof(msg));
+    msg[0] = data;
+    CryptoPP::Tiger::InitState(digest);
+    CryptoPP::Tiger::Transform(digest, msg);
+    return digest[0]; // the first 8 bytes of the digest
+  }
+
+  void seed(uint64_t s) {
+    block[0] = 0; block[1] = s; block[2] = 0x01;
+    block[3] = block[4] = block[5] = block[6] = 0;
+    block[7] = 16 * 8;
+  }
+};
+
+using CMHasherTiger = CMHasher;
+
+// SipHash-C-D on a single 64-bit word with a 128-bit key derived from the seed
+// see https://www.aumasson.jp/siphash/siphash.pdf
+template<int C, int D>
+class CMHasherSip final {
+  uint64_t k0, k1;
+
+  template<typename W>
+  static __always_inline W rotl(W v, int b) { return (v << b) | (v >> (64 - b)); }
+
+  template<typename W>
+  static __always_inline void round(W &v0, W &v1, W &v2, W &v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+  }
 
 public:
-  CMHasher() {
-    // set an initial seed
-    *(uint64_t *)(msg+8) = cm_get_random_uint64();
+  CMHasherSip() { seed(cm_get_random_uint64()); }
+  CMHasherSip(uint64_t s) { seed(s); }
+  CMHasherSip(uint64_t k0, uint64_t k1) : k0(k0), k1(k1) {}
+
+  template<typename W>
+  __always_inline W hash(W data) const {
+    W v0 = W{} ^ (k0 ^ 0x736f6d6570736575ull), v1 = W{} ^ (k1 ^ 0x646f72616e646f6dull);
+    W v2 = W{} ^ (k0 ^ 0x6c7967656e657261ull), v3 = W{} ^ (k1 ^ 0x7465646279746573ull);
+    v3 ^= data; for(int i=0; i<C; i++) round(v0, v1, v2, v3); v0 ^= data;
+    const uint64_t b = 8ull << 56; // message length
+    v3 ^= b;    for(int i=0; i<C; i++) round(v0, v1, v2, v3); v0 ^= b;
+    v2 ^= 0xff; for(int i=0; i<D; i++) round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
   }
 
-  CMHasher(uint64_t s) { *(uint64_t *)(msg+8) = s; }
+  uint64_t operator () (uint64_t data) const { return hash(data); }
 
-  uint64_t operator () (uint64_t data) {
-    *(uint64_t *)(msg) = data;
-    hasher.Update(msg, 16);
-    hasher.TruncatedFinal(result, 8);
-    return *(uint64_t *)(result);
+  void operator () (const uint64_t *data, uint64_t *rv, unsigned int n) const {
+    if constexpr (cm_u64v_lanes >= 4) cm_map_u64v(data, rv, n, [this](auto v) { return hash(v); });
+    else for(unsigned int i=0; i<n; i++) rv[i] = hash(data[i]); // SSE2 has no 64-bit rotate, scalar is faster
   }
 
   void seed(uint64_t s) {
-    *(uint64_t *)(msg+8) = s;
+    k0 = s;
+    k1 = (s ^ (s >> 30)) * 0xbf58476d1ce4e5b9ull; // splitmix64 finalizer
+    k1 = (k1 ^ (k1 >> 27)) * 0x94d049bb133111ebull;
+    k1 ^= k1 >> 31;
+  }
+};
+
+using CMHasherSip13 = CMHasherSip<1, 3>;
+
+// keyed multiply-xorshift mixer (fast, not cryptographic)
+class CMHasherMix final {
+  uint64_t k0, k1;
+
+  template<typename W>
+  static __always_inline W mix(W v) { // the finalizer of MurmurHash3
+    v ^= v >> 33; v *= 0xff51afd7ed558ccdull;
+    v ^= v >> 33; v *= 0xc4ceb9fe1a85ec53ull;
+    return v ^ (v >> 33);
+  }
+
+public:
+  CMHasherMix() { seed(cm_get_random_uint64()); }
+  CMHasherMix(uint64_t s) { seed(s); }
+
+  uint64_t operator () (uint64_t data) const { return mix(mix(data ^ k0) + k1); }
+
+  void operator () (const uint64_t *data, uint64_t *rv, unsigned int n) const {
+    auto f = [this](auto v) { return mix(mix(v ^ k0) + k1); };
+    if constexpr (cm_u64v_lanes >= 4) cm_map_u64v(data, rv, n, f);
+    else for(unsigned int i=0; i<n; i++) rv[i] = f(data[i]); // SSE2 has no 64-bit multiply, scalar is faster
+  }
+
+  void seed(uint64_t s) {
+    k0 = s;
+    k1 = mix(s + 0x9e3779b97f4a7c15ull);
+  }
+};
+
+// PRINCE, a low-latency 64-bit block cipher with a 128-bit key derived from the seed
+// see https://eprint.iacr.org/2012/529.pdf
+// The state is kept nibble-sliced in place: the S-box is evaluated as a boolean circuit on all 16 nibbles at once
+// and the linear layers are a few masked shifts, so the same code encrypts one block (uint64_t)
+// or a vector of blocks in parallel (cm_u64v).
+class CMPrince final {
+  static constexpr uint8_t sbox_t[16]     = {0xb,0xf,0x3,0x2,0xa,0xc,0x9,0x1,0x6,0x7,0x8,0x0,0xe,0x5,0xd,0x4};
+  static constexpr uint8_t sbox_inv_t[16] = {0xb,0x7,0x3,0x2,0xf,0xd,0x8,0x9,0xa,0x6,0x4,0x0,0x5,0xe,0xc,0x1};
+  static constexpr int sr_t[16] = {0,5,10,15,4,9,14,3,8,13,2,7,12,1,6,11}; // ShiftRows, nibble i <- nibble sr_t[i]
+  static constexpr uint64_t rc[12] = {
+    0x0000000000000000ull, 0x13198a2e03707344ull, 0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull,
+    0x452821e638d01377ull, 0xbe5466cf34e90c6cull, 0x7ef84f78fd955cb1ull, 0x85840851f1ac43aaull,
+    0xc882d32f25323c54ull, 0x64a51195e0e3610dull, 0xd3b5a399ca0c2399ull, 0xc0ac29b7c97c50ddull};
+  static constexpr uint64_t nib_lsb = 0x1111111111111111ull;
+
+  uint64_t rk[12]; // round keys with the round constants folded in
+
+  // linear layers: M' (LM), ShiftRows (LSR) and its inverse (LSRI)
+  enum { LM, LSR, LSRI };
+
+  // nibble n (0 is the most significant) sits at bit 60-4n, a linear layer is the XOR of
+  // the state shifted by D nibbles (the source nibble is n+D) and masked by lmask(L, D)
+  static constexpr uint64_t lmask(int l, int d) {
+    uint64_t m = 0;
+    for(int n=0; n<16; n++) {
+      if(l == LSR  && sr_t[n] - n == d) m |= 0xfull << (60-4*n);
+      if(l == LSRI && n - sr_t[n] == d) m |= 0xfull << (60-4*sr_t[n]);
+      if(l == LM) { // the 16x16 M-hat matrices, M-hat0 for the first and last column of 16 bits
+        int r = n % 4, c = r + d, hat = (n/4 == 1 || n/4 == 2);
+        if(c >= 0 && c < 4)
+          for(int j=0; j<4; j++)
+            if((r + c + hat) % 4 != 3 - j) m |= 1ull << (60-4*n+j);
+      }
+    }
+    return m;
+  }
+
+  template<int L, int D, typename W>
+  static __always_inline W lterm(W x) {
+    constexpr uint64_t m = lmask(L, D);
+    if constexpr (m == 0)     return W{};
+    else if constexpr (D > 0) return (x << (4*D)) & m;
+    else                      return (x >> (-4*D)) & m;
+  }
+
+  template<int L, typename W, int... I>
+  static __always_inline W linear(W x, std::integer_sequence<int, I...>) {
+    return (lterm<L, I-15>(x) ^ ...);
+  }
+
+  template<int L, typename W>
+  static __always_inline W linear(W x) { return linear<L>(x, std::make_integer_sequence<int, 31>{}); }
+
+  // algebraic normal form of output bit j of an S-box, bit m is set if the monomial of the input bits in m is present
+  static constexpr uint16_t anf(const uint8_t *t, int j) {
+    uint16_t f = 0;
+    for(int v=0; v<16; v++) f |= ((t[v] >> j) & 1) << v;
+    for(int i=0; i<4; i++)
+      for(int m=0; m<16; m++)
+        if(m & (1 << i)) f ^= ((f >> (m ^ (1 << i))) & 1) << m;
+    return f;
+  }
+
+  template<bool INV, int J, typename W, int... M>
+  static __always_inline W sbox_bit(const W *mono, std::integer_sequence<int, M...>) {
+    constexpr uint16_t f = anf(INV ? sbox_inv_t : sbox_t, J);
+    W o = ((((f >> M) & 1) && M ? mono[M] : W{}) ^ ...) & nib_lsb;
+    if constexpr (f & 1) o ^= nib_lsb;
+    return o << J;
+  }
+
+  // the S-box evaluated by its algebraic normal form on all nibbles,
+  // only the lowest bit of each nibble is valid in the intermediate monomials
+  template<bool INV, typename W>
+  static __always_inline W sbox(W x) {
+    W mono[16];
+    mono[1] = x; mono[2] = x >> 1; mono[4] = x >> 2; mono[8] = x >> 3;
+    for(int m=3; m<16; m++) if(m & (m-1)) mono[m] = mono[m & (m-1)] & mono[m & -m];
+    constexpr auto ms = std::make_integer_sequence<int, 16>{};
+    return sbox_bit<INV, 0>(mono, ms) | sbox_bit<INV, 1>(mono, ms) | sbox_bit<INV, 2>(mono, ms) | sbox_bit<INV, 3>(mono, ms);
+  }
+
+  template<typename W>
+  __always_inline void encrypt(W &s) const {
+    s ^= rk[0];
+    for(int i=1; i<6; i++) s = linear<LSR>(linear<LM>(sbox<false>(s))) ^ rk[i];
+    s = sbox<true>(linear<LM>(sbox<false>(s)));
+    for(int i=6; i<11; i++) s = sbox<true>(linear<LM>(linear<LSRI>(s ^ rk[i])));
+    s ^= rk[11];
+  }
+
+public:
+  CMPrince() { seed(cm_get_random_uint64()); }
+  CMPrince(uint64_t s) { seed(s); }
+  CMPrince(uint64_t k0, uint64_t k1) { set_key(k0, k1); }
+
+  uint64_t operator () (uint64_t data) const { encrypt(data); return data; }
+
+  void operator () (const uint64_t *data, uint64_t *rv, unsigned int n) const {
+    cm_map_u64v(data, rv, n, [this](auto v) { encrypt(v); return v; });
+  }
+
+  void set_key(uint64_t k0, uint64_t k1) {
+    rk[0] = k0 ^ k1;
+    for(int i=1; i<11; i++) rk[i] = rc[i] ^ k1;
+    rk[11] = rc[11] ^ k1 ^ ((k0 >> 1) | (k0 << 63)) ^ (k0 >> 63); // k0' = (k0 >>> 1) ^ (k0 >> 63)
+  }
+
+  void seed(uint64_t s) {
+    uint64_t k1 = (s ^ (s >> 30)) * 0xbf58476d1ce4e5b9ull; // splitmix64 finalizer
+    k1 = (k1 ^ (k1 >> 27)) * 0x94d049bb133111ebull;
+    set_key(s, k1 ^ (k1 >> 31));
   }
 };
 
@@ -75,14 +370,22 @@ class AddrXORHash final
 {
   std::vector<uint64_t> keys;
 
-  uint32_t hash(uint64_t mask, uint64_t addr) {
-    auto rv = mask & addr;
-    rv = (rv >> 32) ^ (rv & 0x0ffffffffull);
-    rv = (rv >> 16) ^ (rv & 0x0ffffull);
-    rv = (rv >>  8) ^ (rv & 0x0ffull);
-    rv = (rv >>  4) ^ (rv & 0x0full);
-    rv = (rv >>  2) ^ (rv & 0x03ull);
-    rv = (rv >>  1) ^ (rv & 0x01ull);
+  // parity of mask & addr
+  template<typename W>
+  static __always_inline W hash(uint64_t mask, W addr) {
+    if constexpr (std::is_same_v<W, uint64_t>) return __builtin_parityll(addr & mask); // popcnt if available
+    else {
+      auto rv = addr & mask;
+      rv ^= rv >> 32; rv ^= rv >> 16; rv ^= rv >> 8;
+      rv ^= rv >> 4;  rv ^= rv >> 2;  rv ^= rv >> 1;
+      return rv & 1;
+    }
+  }
+
+  template<typename W>
+  __always_inline W hash(W addr) const {
+    W rv = W{};
+    for(auto g: keys) rv = (rv << 1) | hash(g, addr);
     return rv;
   }
 
@@ -99,10 +402,13 @@ public:
     keys = k;
   }
 
-  uint32_t operator() (uint64_t addr) {
-    uint64_t rv = 0;
-    for(auto g: keys) rv = (rv << 1) | hash(g, addr);
-    return rv;
+  unsigned int width() const { return keys.size(); }
+
+  uint32_t operator() (uint64_t addr) const { return hash(addr); }
+
+  // hash n addresses using SIMD
+  void operator() (const uint64_t *addr, uint32_t *rv, unsigned int n) const {
+    cm_map_u64v(addr, rv, n, [this](auto v) { return hash(v); });
   }
 };
 
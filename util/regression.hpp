@@ -31,6 +31,7 @@ protected:
   std::vector<DT* >       data_pool;   // data copy
   std::vector<bool>     wflag;       // whether written
   std::vector<bool>     iflag;       // belong to instruction
+  static constexpr uint64_t blk_addr_mask = addr_mask & ~(uint64_t)(cm_data_block_size<DT>() - 1); // one address per block
 
 public:
   RegressionGen()
@@ -44,8 +45,8 @@ public:
     wflag.resize(total);
     iflag.resize(total);
     for(unsigned int i=0; i<total; i++) {
-      auto addr = hasher(gi++) & addr_mask;
-      while(addr_map.count(addr)) addr = hasher(gi++) & addr_mask;
+      auto addr = hasher(gi++) & blk_addr_mask;
+      while(addr_map.count(addr)) addr = hasher(gi++) & blk_addr_mask;
       addr_pool[i] = addr;
       addr_map[addr_pool[i]] = i;
       wflag[i] = false;
@@ -0,0 +1,93 @@
+#ifndef CM_UTIL_SIMD_HPP
+#define CM_UTIL_SIMD_HPP
+
+// small data-parallel kernels used on the hot path of the cache model
+// vector implementations are selected at compile time according to the target ISA (e.g. -mavx2 or -march=native,
+// which the release build passes through SIMD in the Makefile), otherwise a scalar fallback is used
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <version>
+#ifdef __cpp_lib_bitops
+// for the countr_zero() supported in C++20
+#include <bit>
+#endif
+
+// a vector of 64-bit lanes (GCC vector extension) as wide as the widest enabled SIMD register
+#if defined(__AVX512F__)
+constexpr unsigned int cm_u64v_lanes = 8;
+#elif defined(__AVX2__)
+constexpr unsigned int cm_u64v_lanes = 4;
+#else
+constexpr unsigned int cm_u64v_lanes = 2;
+#endif
+typedef uint64_t cm_u64v __attribute__ ((vector_size (8 * cm_u64v_lanes)));
+typedef uint32_t cm_u32v __attribute__ ((vector_size (4 * cm_u64v_lanes)));
+
+__always_inline cm_u64v cm_load_u64v(const uint64_t *p) { cm_u64v v; memcpy(&v, p, sizeof(v)); return v; }
+__always_inline void cm_store_u64v(uint64_t *p, cm_u64v v) { memcpy(p, &v, sizeof(v)); }
+
+// store the lower 32 bits of each lane
+__always_inline void cm_store_u32v(uint32_t *p, cm_u64v v) {
+  cm_u32v w = __builtin_convertvector(v, cm_u32v);
+  memcpy(p, &w, sizeof(w));
+}
+
+// rv[i] = f(data[i]) for n words, f is applied to cm_u64v_lanes words at a time and to the remaining words one by one,
+// so it must accept both uint64_t and cm_u64v (e.g. a generic lambda); data and rv may be the same array
+template<typename F>
+__always_inline void cm_map_u64v(const uint64_t *data, uint64_t *rv, unsigned int n, F f) {
+  unsigned int i = 0;
+  for(; i+cm_u64v_lanes <= n; i+=cm_u64v_lanes) cm_store_u64v(rv+i, f(cm_load_u64v(data+i)));
+  for(; i<n; i++) rv[i] = f(data[i]);
+}
+
+// the same with the lower 32 bits of the results stored
+template<typename F>
+__always_inline void cm_map_u64v(const uint64_t *data, uint32_t *rv, unsigned int n, F f) {
+  unsigned int i = 0;
+  for(; i+cm_u64v_lanes <= n; i+=cm_u64v_lanes) cm_store_u32v(rv+i, f(cm_load_u64v(data+i)));
+  for(; i<n; i++) rv[i] = f(data[i]);
+}
+
+// return the index of the lowest set bit (v must not be 0)
+__always_inline uint32_t cm_ctz(uint64_t v) {
+#ifdef __cpp_lib_bitops
+  return std::countr_zero(v);
+#else
+  return __builtin_ctzll(v);
+#endif
+}
+
+// compare a key with N 64-bit tags and return a bitmask of the matching tags
+// N: number of tags, must be a multiple of 4 and no more than 64
+// tags must be aligned to 64B when N >= 8, or 32B when N == 4
+template<int N> requires (N % 4 == 0 && N <= 64)
+__always_inline uint64_t cm_match_mask(const uint64_t *tags, uint64_t key) {
+  uint64_t mask = 0;
+#if defined(__AVX512F__)
+  if constexpr (N % 8 == 0) {
+    const __m512i k = _mm512_set1_epi64(key);
+    for(int i=0; i<N; i+=8)
+      mask |= static_cast<uint64_t>(_mm512_cmpeq_epi64_mask(_mm512_load_si512(tags+i), k)) << i;
+    return mask;
+  }
+#endif
+#if defined(__AVX2__)
+  const __m256i k = _mm256_set1_epi64x(key);
+  for(int i=0; i<N; i+=4) {
+    auto eq = _mm256_cmpeq_epi64(_mm256_load_si256(reinterpret_cast<const __m256i *>(tags+i)), k);
+    mask |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << i;
+  }
+#else
+  for(int i=0; i<N; i++) mask |= static_cast<uint64_t>(tags[i] == key) << i;
+#endif
+  return mask;
+}
+
+#endif